@@ -0,0 +1,57 @@
+#include "CpuSolver.h"
+
+#include "SolverRegistry.h"
+
+#include <memory>
+
+// The threaded backend keeps as many particles interactive per physical core as the scalar one does on its own
+static SolverRegistry::Registrar s_ScalarBackend{ SolverRegistry::Entry{
+	"scalar", 0, FluidSolver::s_BaseParticleCount, false,
+	[]() { return std::make_unique<CpuSolver>("scalar", eng::SimdLevel::Scalar, 1); }
+} };
+
+static SolverRegistry::Registrar s_SimdBackend{ SolverRegistry::Entry{
+	"simd", 1, FluidSolver::s_BaseParticleCount * static_cast<int>(eng::JobSystem::GetPhysicalCoreCount()), false,
+	[]() { return std::make_unique<CpuSolver>("simd", eng::CpuFeatures::GetSimdLevel(), 0); }
+} };
+
+CpuSolver::CpuSolver(const char* name, eng::SimdLevel simdLevel, uint32_t threadCount)
+	: m_Name(name), m_ThreadCount(threadCount) {
+	m_Solver.SetSimdLevel(simdLevel);
+}
+
+void CpuSolver::Init(const SimulationParams& params) {
+	SetParams(params);
+
+	m_Solver.Start(m_Params);
+	m_Steps = 0;
+}
+
+void CpuSolver::SetParams(const SimulationParams& params) {
+	m_Params = params;
+
+	if (m_ThreadCount)
+		m_Params.threadCount = m_ThreadCount;
+}
+
+void CpuSolver::Step(double dt) {
+	m_Solver.Update(m_Params, dt);
+	m_Steps++;
+}
+
+SolverView CpuSolver::Positions() {
+	const ParticleStore& particles = m_Solver.GetParticles();
+
+	SolverView view;
+	view.posX = particles.posX;
+	view.posY = particles.posY;
+	view.posZ = particles.posZ;
+	view.velX = particles.velX;
+	view.velY = particles.velY;
+	view.velZ = particles.velZ;
+	view.density = particles.density;
+	view.slot = particles.slot;
+	view.step = m_Steps;
+
+	return view;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <CpuFeatures.h>
+
+#include "FluidSolver.h"
+#include "Solver.h"
+
+#include <cstdint>
+
+//
+// FluidSolver as a backend. "scalar" is the single threaded reference with the scalar pair kernels,
+// "simd" runs the widest kernels the CPU has on every physical core.
+//
+class CpuSolver : public Solver {
+public:
+	// threadCount 0 takes SimulationParams::threadCount
+	CpuSolver(const char* name, eng::SimdLevel simdLevel, uint32_t threadCount);
+
+	void Init(const SimulationParams& params) override;
+	void SetParams(const SimulationParams& params) override;
+	void Step(double dt) override;
+
+	SolverView Positions() override;
+	inline uint64_t GetStepCount() const override { return m_Steps; }
+	inline PressureSolveReport GetPressureReport() const override { return m_Solver.GetPressureReport(); }
+	inline bool Supports(PressureModel) const override { return true; }
+
+	inline const char* GetName() const override { return m_Name; }
+
+	inline FluidSolver& GetFluidSolver() { return m_Solver; }
+
+private:
+	const char* m_Name;
+	uint32_t m_ThreadCount;
+
+	SimulationParams m_Params;
+	FluidSolver m_Solver;
+	uint64_t m_Steps = 0;
+};
\ No newline at end of file
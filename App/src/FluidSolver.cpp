@@ -0,0 +1,652 @@
+#include "FluidSolver.h"
+
+double RandomDouble(double lowerBound, double upperBound) {
+	std::default_random_engine randEng(rand());
+	std::uniform_real_distribution<double> unifDist(lowerBound, upperBound);
+	return unifDist(randEng);
+}
+
+void FluidSolver::Start(const SimulationParams& params) {
+	m_Params = params;
+
+	if (m_Params.threadCount != m_ThreadCount) {
+		m_JobSystem.SetThreadCount(m_Params.threadCount);
+		m_ThreadCount = m_Params.threadCount;
+	}
+
+	// Interactions never reach further than the kernel support, listed pairs no further than that plus the skin.
+	// The neighbour list refits the cells to both at every rebuild, so the 27 cells around a particle cover them.
+	m_Neighbours.SetCutoff(Kernels::s_Support, m_MaxNeighbourSkin);
+	m_BoxSize = glm::dvec3{ m_SimulationWidth, m_SimulationDepth, m_SimulationHeight } * m_Params.boxScale;
+	m_Grid.Resize(glm::dvec3{ 0.0 }, m_BoxSize, Kernels::s_Support);
+
+	Spawn(m_Params, m_Particles);
+
+	// Spawn order is random in space, sort on the first step
+	m_StepsSinceReorder = m_ReorderInterval;
+}
+
+void FluidSolver::Spawn(const SimulationParams& params, ParticleStore& particles) {
+	particles.Clear();
+	particles.Resize(params.particleCount);
+
+	const glm::dvec3& startVel = params.startVelocity;
+	const double spawnScale = params.boxScale;
+
+	for (int i = 0; i < params.particleCount; i++) {
+		ParticleView particle = particles[i];
+
+		particle.SetPos(glm::dvec3{
+			  RandomDouble(s_XSpanS * spawnScale, s_XSpanE * spawnScale)
+			, RandomDouble(s_YSpanS * spawnScale, s_YSpanE * spawnScale)
+			, RandomDouble(s_ZSpanS * spawnScale, s_ZSpanE * spawnScale)
+		});
+
+		particle.SetVel(glm::dvec3{
+			  RandomDouble(startVel.x - 1.0, startVel.x + 1.0)
+			, RandomDouble(startVel.y - 1.0, startVel.y + 1.0)
+			, RandomDouble(startVel.z - 1.0, startVel.z + 1.0)
+		});
+
+		particle.Density() = 0.0;
+		particle.Pressure() = 0.0;
+	}
+}
+
+double FluidSolver::BoxScaleFor(int particleCount) {
+	return std::max(1.0, std::cbrt(static_cast<double>(particleCount) / s_BaseParticleCount));
+}
+
+void FluidSolver::Update(const SimulationParams& params, double dt) {
+	m_Params = params;
+
+	const bool gravity = m_Params.gravity;
+	const bool collisions = m_Params.collisions;
+	const bool pcisph = m_Params.pressureModel == PressureModel::Pcisph;
+	const bool pbf = m_Params.pressureModel == PressureModel::Pbf;
+
+	const size_t count = m_Particles.Size();
+
+	// Seconds since the previous call, splits the step into its phases
+	using Clock = std::chrono::steady_clock;
+	Clock::time_point phaseStart = Clock::now();
+
+	auto lap = [&phaseStart]() {
+		const Clock::time_point now = Clock::now();
+		const double seconds = std::chrono::duration<double>(now - phaseStart).count();
+		phaseStart = now;
+		return seconds;
+	};
+
+	if (++m_StepsSinceReorder >= m_ReorderInterval) {
+		ReorderParticles();
+		m_StepsSinceReorder = 0;
+	}
+
+	m_Stats.reorderSeconds += lap();
+
+	// Refresh the pair distances, the grid and the pairs are only rebuilt once particles moved far enough
+	m_Neighbours.Update(m_Particles, m_Grid, m_JobSystem, dt);
+
+	const size_t pairCount = m_Neighbours.PairCount();
+
+	m_Stats.neighbourSeconds += lap();
+
+	const double gravityDv = gravity ? s_Gravity * dt : 0.0;
+
+	if (pbf) {
+		StepPbf(dt, gravityDv);
+
+		m_Stats.pressureSeconds += lap();
+		m_Stats.pressureIterations += m_PressureReport.iterations;
+		m_Stats.steps++;
+		return;
+	}
+
+	// Calculate density and pressure
+	// The kernel weight of a pair is added to both particles on top of the particle's own, the density
+	// array holds the sum until the last step. The viscosity needs the density in every model, the
+	// pressure solve finds the density of its predicted positions itself afterwards.
+	const double mass = m_Params.restDensity / m_RestLattice.weightSum;
+
+	std::fill(m_Particles.density.begin(), m_Particles.density.end(), Kernels::Density::Value(0.0, 0.0));
+
+	m_Neighbours.ForEachBlock(m_JobSystem, m_BlockChunkSize, [&](const PairSpan& block) {
+		alignas(64) double weight[s_PairTile];
+
+		for (size_t offset = 0; offset < block.count; offset += s_PairTile) {
+			const PairSpan tile = block.Slice(offset, s_PairTile);
+			m_PairKernels.Densities<Kernels::Density>(tile, weight);
+
+			for (size_t p = 0; p < tile.count; p++) {
+				m_Particles.density[tile.first[p]] += weight[p];
+				m_Particles.density[tile.second[p]] += weight[p];
+			}
+		}
+	});
+
+	// Weakly compressible equation of state, only compression pushes. The pressure solve starts from zero.
+	const double stiffness = pcisph ? 0.0 : m_Params.stiffness * s_StiffnessScale * m_Params.restDensity;
+
+	m_JobSystem.ParallelFor(0, count, m_ChunkSize, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			m_Particles.density[i] *= mass;
+			m_Particles.pressure[i] = stiffness * std::max(m_Particles.density[i] / m_Params.restDensity - 1.0, 0.0);
+		}
+	});
+
+	m_Stats.densitySeconds += lap();
+	m_Stats.pairsEvaluated += pairCount;
+
+	// Collisions, pressure and viscosity, the pressure solve adds its own pressure afterwards
+	// Every unordered pair is visited once and the change is applied to both ends with
+	// opposite signs. Velocities are read as they were before the pass and blocks of one
+	// colour never share a particle, so the accumulators are written without races.
+	std::fill(m_Particles.deltaVelX.begin(), m_Particles.deltaVelX.end(), 0.0);
+	std::fill(m_Particles.deltaVelY.begin(), m_Particles.deltaVelY.end(), 0.0);
+	std::fill(m_Particles.deltaVelZ.begin(), m_Particles.deltaVelZ.end(), 0.0);
+
+	PairForceParams forceParams;
+	forceParams.radius = m_ParticleRadius;
+	forceParams.mass = mass;
+	forceParams.restDensity = m_Params.restDensity;
+	forceParams.viscosity = m_Params.viscosity * s_ViscosityScale;
+	forceParams.damping = m_Params.damping;
+	forceParams.dt = dt;
+	forceParams.collisions = collisions;
+
+	m_Neighbours.ForEachBlock(m_JobSystem, m_BlockChunkSize, [&](const PairSpan& block) {
+		alignas(64) double deltaVelX[s_PairTile];
+		alignas(64) double deltaVelY[s_PairTile];
+		alignas(64) double deltaVelZ[s_PairTile];
+
+		for (size_t offset = 0; offset < block.count; offset += s_PairTile) {
+			const PairSpan tile = block.Slice(offset, s_PairTile);
+			m_PairKernels.PairForces<Kernels>(m_Particles, tile, forceParams, deltaVelX, deltaVelY, deltaVelZ);
+
+			for (size_t p = 0; p < tile.count; p++) {
+				const uint32_t i = tile.first[p];
+				const uint32_t j = tile.second[p];
+
+				m_Particles.deltaVelX[i] += deltaVelX[p];
+				m_Particles.deltaVelY[i] += deltaVelY[p];
+				m_Particles.deltaVelZ[i] += deltaVelZ[p];
+
+				m_Particles.deltaVelX[j] -= deltaVelX[p];
+				m_Particles.deltaVelY[j] -= deltaVelY[p];
+				m_Particles.deltaVelZ[j] -= deltaVelZ[p];
+			}
+		}
+	});
+
+	m_Stats.forceSeconds += lap();
+	m_Stats.pairsEvaluated += pairCount;
+
+	if (pcisph) {
+		SolvePressure(dt, gravityDv);
+
+		m_Stats.pressureSeconds += lap();
+		m_Stats.pressureIterations += m_PressureReport.iterations;
+	}
+	else {
+		m_PressureReport = PressureSolveReport{};
+	}
+
+	// Position Update
+	m_JobSystem.ParallelFor(0, count, m_ChunkSize, [&](size_t begin, size_t end) {
+		double* __restrict posX = m_Particles.posX.data();
+		double* __restrict posY = m_Particles.posY.data();
+		double* __restrict posZ = m_Particles.posZ.data();
+		double* __restrict velX = m_Particles.velX.data();
+		double* __restrict velY = m_Particles.velY.data();
+		double* __restrict velZ = m_Particles.velZ.data();
+		const double* __restrict deltaVelX = m_Particles.deltaVelX.data();
+		const double* __restrict deltaVelY = m_Particles.deltaVelY.data();
+		const double* __restrict deltaVelZ = m_Particles.deltaVelZ.data();
+
+		for (size_t i = begin; i < end; i++) {
+			velX[i] += deltaVelX[i];
+			velY[i] += deltaVelY[i];
+			velZ[i] += deltaVelZ[i] - gravityDv;
+
+			posX[i] += velX[i] * dt;
+			posY[i] += velY[i] * dt;
+			posZ[i] += velZ[i] * dt;
+		}
+
+		for (size_t i = begin; i < end; i++)
+			ApplyBoundary(i);
+	});
+
+	m_Stats.integrationSeconds += lap();
+	m_Stats.steps++;
+}
+
+void FluidSolver::SolvePressure(double dt, double gravityDv) {
+	const size_t count = m_Particles.Size();
+	const double restDensity = m_Params.restDensity;
+
+	// Factor from density error to pressure, for a particle at rest
+	const double mass = restDensity / m_RestLattice.weightSum;
+	const double beta = 2.0 * (dt * mass / restDensity) * (dt * mass / restDensity);
+	const double delta = 1.0 / (beta * m_RestLattice.gradientSqSum);
+	const double pressureScale = -dt * mass / (restDensity * restDensity);
+
+	std::fill(m_Particles.pressure.begin(), m_Particles.pressure.end(), 0.0);
+	std::fill(m_Particles.pressureVelX.begin(), m_Particles.pressureVelX.end(), 0.0);
+	std::fill(m_Particles.pressureVelY.begin(), m_Particles.pressureVelY.end(), 0.0);
+	std::fill(m_Particles.pressureVelZ.begin(), m_Particles.pressureVelZ.end(), 0.0);
+
+	const double tolerance = std::max(m_Params.densityTolerance, 0.0);
+	const uint32_t maxIterations = static_cast<uint32_t>(std::max(m_Params.maxPressureIterations, 1));
+
+	m_PressureReport = PressureSolveReport{};
+
+	while (m_PressureReport.iterations < maxIterations) {
+		// Predict the positions with the pressure found so far
+		m_JobSystem.ParallelFor(0, count, m_ChunkSize, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				const double velX = m_Particles.velX[i] + m_Particles.deltaVelX[i] + m_Particles.pressureVelX[i];
+				const double velY = m_Particles.velY[i] + m_Particles.deltaVelY[i] + m_Particles.pressureVelY[i];
+				const double velZ = m_Particles.velZ[i] + m_Particles.deltaVelZ[i] + m_Particles.pressureVelZ[i] - gravityDv;
+
+				m_Particles.predPosX[i] = m_Particles.posX[i] + velX * dt;
+				m_Particles.predPosY[i] = m_Particles.posY[i] + velY * dt;
+				m_Particles.predPosZ[i] = m_Particles.posZ[i] + velZ * dt;
+
+				m_Particles.density[i] = mass * Kernels::Density::Value(0.0, 0.0);
+			}
+		});
+
+		// Predicted density, pairs were listed with the skin, so the ones that close in during the step are there
+		m_Neighbours.ForEachBlock(m_JobSystem, m_BlockChunkSize, [&](const PairSpan& block) {
+			for (size_t p = 0; p < block.count; p++) {
+				const uint32_t i = block.first[p];
+				const uint32_t j = block.second[p];
+
+				const double dx = m_Particles.predPosX[i] - m_Particles.predPosX[j];
+				const double dy = m_Particles.predPosY[i] - m_Particles.predPosY[j];
+				const double dz = m_Particles.predPosZ[i] - m_Particles.predPosZ[j];
+
+				const double distSq = dx * dx + dy * dy + dz * dz;
+				const double density = mass * Kernels::Density::Value(std::sqrt(distSq), distSq);
+
+				m_Particles.density[i] += density;
+				m_Particles.density[j] += density;
+			}
+		});
+
+		// Pressure never goes negative, free surfaces would otherwise pull particles together.
+		// Only compression counts towards the error for the same reason.
+		m_ChunkCompression.assign((count + m_ChunkSize - 1) / m_ChunkSize, CompressionSum{});
+
+		m_JobSystem.ParallelFor(0, count, m_ChunkSize, [&](size_t begin, size_t end) {
+			CompressionSum& compression = m_ChunkCompression[begin / m_ChunkSize];
+
+			for (size_t i = begin; i < end; i++) {
+				const double error = m_Particles.density[i] - restDensity;
+
+				m_Particles.pressure[i] = std::max(m_Particles.pressure[i] + delta * error, 0.0);
+
+				if (error > 0.0) {
+					compression.sum += error / restDensity;
+					compression.count++;
+				}
+			}
+		});
+
+		m_PressureReport.iterations++;
+		m_PressureReport.densityError = MeanCompression();
+
+		// Pressure velocity change from the updated pressure
+		std::fill(m_Particles.pressureVelX.begin(), m_Particles.pressureVelX.end(), 0.0);
+		std::fill(m_Particles.pressureVelY.begin(), m_Particles.pressureVelY.end(), 0.0);
+		std::fill(m_Particles.pressureVelZ.begin(), m_Particles.pressureVelZ.end(), 0.0);
+
+		m_Neighbours.ForEachBlock(m_JobSystem, m_BlockChunkSize, [&](const PairSpan& block) {
+			for (size_t p = 0; p < block.count; p++) {
+				const uint32_t i = block.first[p];
+				const uint32_t j = block.second[p];
+
+				const double dx = m_Particles.predPosX[i] - m_Particles.predPosX[j];
+				const double dy = m_Particles.predPosY[i] - m_Particles.predPosY[j];
+				const double dz = m_Particles.predPosZ[i] - m_Particles.predPosZ[j];
+
+				const double scale = pressureScale * (m_Particles.pressure[i] + m_Particles.pressure[j])
+					* Kernels::Pressure::GradientScale(std::sqrt(dx * dx + dy * dy + dz * dz));
+
+				m_Particles.pressureVelX[i] += scale * dx;
+				m_Particles.pressureVelY[i] += scale * dy;
+				m_Particles.pressureVelZ[i] += scale * dz;
+
+				m_Particles.pressureVelX[j] -= scale * dx;
+				m_Particles.pressureVelY[j] -= scale * dy;
+				m_Particles.pressureVelZ[j] -= scale * dz;
+			}
+		});
+
+		// A state far from rest, like the random spawn, can't be solved in one step. Spreading the
+		// correction over a few steps keeps the pressure from launching particles through each other.
+		const double maxPressureVel = s_MaxPressureShift * m_ParticleRadius / dt;
+
+		m_JobSystem.ParallelFor(0, count, m_ChunkSize, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				const double speedSq = m_Particles.pressureVelX[i] * m_Particles.pressureVelX[i]
+					+ m_Particles.pressureVelY[i] * m_Particles.pressureVelY[i]
+					+ m_Particles.pressureVelZ[i] * m_Particles.pressureVelZ[i];
+
+				if (speedSq > maxPressureVel * maxPressureVel) {
+					const double scale = maxPressureVel / std::sqrt(speedSq);
+
+					m_Particles.pressureVelX[i] *= scale;
+					m_Particles.pressureVelY[i] *= scale;
+					m_Particles.pressureVelZ[i] *= scale;
+				}
+			}
+		});
+
+		if (m_PressureReport.densityError <= tolerance)
+			break;
+	}
+
+	m_JobSystem.ParallelFor(0, count, m_ChunkSize, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			m_Particles.deltaVelX[i] += m_Particles.pressureVelX[i];
+			m_Particles.deltaVelY[i] += m_Particles.pressureVelY[i];
+			m_Particles.deltaVelZ[i] += m_Particles.pressureVelZ[i];
+		}
+	});
+}
+
+void FluidSolver::StepPbf(double dt, double gravityDv) {
+	const size_t count = m_Particles.Size();
+	const double restDensity = m_Params.restDensity;
+
+	const double mass = restDensity / m_RestLattice.weightSum;
+
+	// Constraint gradient per kernel gradient, and the softening of the constraints
+	const double gradientCoef = mass / restDensity;
+	const double relaxation = s_PbfRelaxation * gradientCoef * gradientCoef * m_RestLattice.gradientSqSum;
+
+	// A projection moves a particle no further than the pressure solve does in a step
+	const double maxShift = s_MaxPressureShift * m_ParticleRadius;
+
+	// Particles on the walls have too few neighbours to ever be compressed, the density constraint
+	// lets them pile onto each other there. Collisions keep every pair at least a radius apart.
+	const double minDistance = m_Params.collisions ? m_ParticleRadius : 0.0;
+	const double coincidentDistance = KernelMath::s_MinDistanceRatio * Kernels::s_Support;
+
+	const glm::dvec3 boxSize = m_BoxSize;
+
+	// Predict with gravity only, the constraints take the place of pressure and collisions
+	m_JobSystem.ParallelFor(0, count, m_ChunkSize, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			m_Particles.predPosX[i] = m_Particles.posX[i] + m_Particles.velX[i] * dt;
+			m_Particles.predPosY[i] = m_Particles.posY[i] + m_Particles.velY[i] * dt;
+			m_Particles.predPosZ[i] = m_Particles.posZ[i] + (m_Particles.velZ[i] - gravityDv) * dt;
+		}
+	});
+
+	const uint32_t iterations = static_cast<uint32_t>(std::max(m_Params.pbfIterations, 1));
+
+	m_PressureReport = PressureSolveReport{};
+
+	for (uint32_t iteration = 0; iteration < iterations; iteration++) {
+		// Density and the constraint gradient sums, the pressure stream holds the squared gradients until the multipliers replace them
+		std::fill(m_Particles.deltaPosX.begin(), m_Particles.deltaPosX.end(), 0.0);
+		std::fill(m_Particles.deltaPosY.begin(), m_Particles.deltaPosY.end(), 0.0);
+		std::fill(m_Particles.deltaPosZ.begin(), m_Particles.deltaPosZ.end(), 0.0);
+		std::fill(m_Particles.pressure.begin(), m_Particles.pressure.end(), 0.0);
+		std::fill(m_Particles.density.begin(), m_Particles.density.end(), mass * Kernels::Density::Value(0.0, 0.0));
+
+		m_Neighbours.ForEachBlock(m_JobSystem, m_BlockChunkSize, [&](const PairSpan& block) {
+			for (size_t p = 0; p < block.count; p++) {
+				const uint32_t i = block.first[p];
+				const uint32_t j = block.second[p];
+
+				const double dx = m_Particles.predPosX[i] - m_Particles.predPosX[j];
+				const double dy = m_Particles.predPosY[i] - m_Particles.predPosY[j];
+				const double dz = m_Particles.predPosZ[i] - m_Particles.predPosZ[j];
+				const double distSq = dx * dx + dy * dy + dz * dz;
+				const double dist = std::sqrt(distSq);
+
+				const double density = mass * Kernels::Density::Value(dist, distSq);
+				const double scale = gradientCoef * Kernels::Pressure::GradientScale(dist);
+				const double gradientSq = scale * scale * distSq;
+
+				m_Particles.density[i] += density;
+				m_Particles.density[j] += density;
+
+				m_Particles.deltaPosX[i] += scale * dx;
+				m_Particles.deltaPosY[i] += scale * dy;
+				m_Particles.deltaPosZ[i] += scale * dz;
+
+				m_Particles.deltaPosX[j] -= scale * dx;
+				m_Particles.deltaPosY[j] -= scale * dy;
+				m_Particles.deltaPosZ[j] -= scale * dz;
+
+				m_Particles.pressure[i] += gradientSq;
+				m_Particles.pressure[j] += gradientSq;
+			}
+		});
+
+		// Lagrange multipliers, kept in the pressure stream. Only compression is a violation,
+		// free surfaces would otherwise pull particles together.
+		m_ChunkCompression.assign((count + m_ChunkSize - 1) / m_ChunkSize, CompressionSum{});
+
+		m_JobSystem.ParallelFor(0, count, m_ChunkSize, [&](size_t begin, size_t end) {
+			CompressionSum& compression = m_ChunkCompression[begin / m_ChunkSize];
+
+			for (size_t i = begin; i < end; i++) {
+				const double constraint = std::max(m_Particles.density[i] / restDensity - 1.0, 0.0);
+
+				const double gradientSq = m_Particles.deltaPosX[i] * m_Particles.deltaPosX[i]
+					+ m_Particles.deltaPosY[i] * m_Particles.deltaPosY[i]
+					+ m_Particles.deltaPosZ[i] * m_Particles.deltaPosZ[i]
+					+ m_Particles.pressure[i];
+
+				m_Particles.pressure[i] = -constraint / (gradientSq + relaxation);
+
+				if (constraint > 0.0) {
+					compression.sum += constraint;
+					compression.count++;
+				}
+			}
+		});
+
+		m_PressureReport.iterations++;
+		m_PressureReport.densityError = MeanCompression();
+
+		// Position corrections, Jacobi style, every particle sees the multipliers of the same iteration
+		std::fill(m_Particles.deltaPosX.begin(), m_Particles.deltaPosX.end(), 0.0);
+		std::fill(m_Particles.deltaPosY.begin(), m_Particles.deltaPosY.end(), 0.0);
+		std::fill(m_Particles.deltaPosZ.begin(), m_Particles.deltaPosZ.end(), 0.0);
+
+		m_Neighbours.ForEachBlock(m_JobSystem, m_BlockChunkSize, [&](const PairSpan& block) {
+			for (size_t p = 0; p < block.count; p++) {
+				const uint32_t i = block.first[p];
+				const uint32_t j = block.second[p];
+
+				const double dx = m_Particles.predPosX[i] - m_Particles.predPosX[j];
+				const double dy = m_Particles.predPosY[i] - m_Particles.predPosY[j];
+				const double dz = m_Particles.predPosZ[i] - m_Particles.predPosZ[j];
+
+				const double dist = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+				// Overlapping pairs are moved apart by half the overlap each, coincident ones have no direction
+				const double overlap = dist < minDistance ? 0.5 * (minDistance - dist) / std::max(dist, coincidentDistance) : 0.0;
+
+				const double scale = gradientCoef * (m_Particles.pressure[i] + m_Particles.pressure[j])
+					* Kernels::Pressure::GradientScale(dist) + overlap;
+
+				m_Particles.deltaPosX[i] += scale * dx;
+				m_Particles.deltaPosY[i] += scale * dy;
+				m_Particles.deltaPosZ[i] += scale * dz;
+
+				m_Particles.deltaPosX[j] -= scale * dx;
+				m_Particles.deltaPosY[j] -= scale * dy;
+				m_Particles.deltaPosZ[j] -= scale * dz;
+			}
+		});
+
+		m_JobSystem.ParallelFor(0, count, m_ChunkSize, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				glm::dvec3 shift{ m_Particles.deltaPosX[i], m_Particles.deltaPosY[i], m_Particles.deltaPosZ[i] };
+
+				const double shiftSq = glm::dot(shift, shift);
+				if (shiftSq > maxShift * maxShift)
+					shift *= maxShift / std::sqrt(shiftSq);
+
+				const glm::dvec3 predPos = glm::clamp(glm::dvec3{ m_Particles.predPosX[i], m_Particles.predPosY[i], m_Particles.predPosZ[i] } + shift,
+					glm::dvec3{ 0.0 }, boxSize);
+
+				m_Particles.predPosX[i] = predPos.x;
+				m_Particles.predPosY[i] = predPos.y;
+				m_Particles.predPosZ[i] = predPos.z;
+			}
+		});
+	}
+
+	// Velocity from the motion of the step
+	m_JobSystem.ParallelFor(0, count, m_ChunkSize, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			m_Particles.velX[i] = (m_Particles.predPosX[i] - m_Particles.posX[i]) / dt;
+			m_Particles.velY[i] = (m_Particles.predPosY[i] - m_Particles.posY[i]) / dt;
+			m_Particles.velZ[i] = (m_Particles.predPosZ[i] - m_Particles.posZ[i]) / dt;
+		}
+	});
+
+	// XSPH viscosity, blends every velocity towards its neighbours. The weights of a particle sum
+	// to less than one, so any viscosity up to one only smooths.
+	const double viscosity = std::clamp(m_Params.viscosity, 0.0, 1.0);
+
+	std::fill(m_Particles.deltaVelX.begin(), m_Particles.deltaVelX.end(), 0.0);
+	std::fill(m_Particles.deltaVelY.begin(), m_Particles.deltaVelY.end(), 0.0);
+	std::fill(m_Particles.deltaVelZ.begin(), m_Particles.deltaVelZ.end(), 0.0);
+
+	m_Neighbours.ForEachBlock(m_JobSystem, m_BlockChunkSize, [&](const PairSpan& block) {
+		for (size_t p = 0; p < block.count; p++) {
+			const uint32_t i = block.first[p];
+			const uint32_t j = block.second[p];
+
+			const double dx = m_Particles.predPosX[i] - m_Particles.predPosX[j];
+			const double dy = m_Particles.predPosY[i] - m_Particles.predPosY[j];
+			const double dz = m_Particles.predPosZ[i] - m_Particles.predPosZ[j];
+
+			const double distSq = dx * dx + dy * dy + dz * dz;
+			const double weight = viscosity * mass * Kernels::Density::Value(std::sqrt(distSq), distSq);
+			const double weightI = weight / m_Particles.density[j];
+			const double weightJ = weight / m_Particles.density[i];
+
+			const double relX = m_Particles.velX[j] - m_Particles.velX[i];
+			const double relY = m_Particles.velY[j] - m_Particles.velY[i];
+			const double relZ = m_Particles.velZ[j] - m_Particles.velZ[i];
+
+			m_Particles.deltaVelX[i] += weightI * relX;
+			m_Particles.deltaVelY[i] += weightI * relY;
+			m_Particles.deltaVelZ[i] += weightI * relZ;
+
+			m_Particles.deltaVelX[j] -= weightJ * relX;
+			m_Particles.deltaVelY[j] -= weightJ * relY;
+			m_Particles.deltaVelZ[j] -= weightJ * relZ;
+		}
+	});
+
+	m_JobSystem.ParallelFor(0, count, m_ChunkSize, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			m_Particles.velX[i] += m_Particles.deltaVelX[i];
+			m_Particles.velY[i] += m_Particles.deltaVelY[i];
+			m_Particles.velZ[i] += m_Particles.deltaVelZ[i];
+
+			m_Particles.posX[i] = m_Particles.predPosX[i];
+			m_Particles.posY[i] = m_Particles.predPosY[i];
+			m_Particles.posZ[i] = m_Particles.predPosZ[i];
+		}
+
+		for (size_t i = begin; i < end; i++)
+			ApplyBoundary(i);
+	});
+}
+
+double FluidSolver::MeanCompression() const {
+	CompressionSum total;
+
+	for (const CompressionSum& compression : m_ChunkCompression) {
+		total.sum += compression.sum;
+		total.count += compression.count;
+	}
+
+	return total.count ? total.sum / total.count : 0.0;
+}
+
+size_t FluidSolver::MemoryFootprint() const {
+	return m_Particles.MemoryFootprint() + m_Grid.MemoryFootprint() + m_Neighbours.MemoryFootprint()
+		+ (m_SortKeys.capacity() + m_SortOrder.capacity()) * sizeof(uint32_t);
+}
+
+void FluidSolver::ApplyBoundary(size_t i) {
+	ParticleView particle = m_Particles[i];
+	glm::dvec3 pos = particle.Pos();
+	glm::dvec3 vel = particle.Vel();
+
+	if (pos.x <= 0) {
+		pos.x = 0;
+		vel.x = -vel.x;
+		vel *= m_Params.damping;
+	}
+
+	if (pos.y <= 0) {
+		pos.y = 0;
+		vel.y = -vel.y;
+		vel *= m_Params.damping;
+	}
+
+	if (pos.z <= 0) {
+		pos.z = 0;
+		vel.z = -vel.z;
+		vel *= m_Params.damping;
+	}
+
+	if (pos.x >= m_BoxSize.x) {
+		pos.x = m_BoxSize.x;
+		vel.x = -vel.x;
+		vel *= m_Params.damping;
+	}
+
+	if (pos.y >= m_BoxSize.y) {
+		pos.y = m_BoxSize.y;
+		vel.y = -vel.y;
+		vel *= m_Params.damping;
+	}
+
+	if (pos.z >= m_BoxSize.z) {
+		pos.z = m_BoxSize.z;
+		vel.z = -vel.z;
+		vel *= m_Params.damping;
+	}
+
+	particle.SetPos(pos);
+	particle.SetVel(vel);
+}
+
+void FluidSolver::ReorderParticles() {
+	const size_t count = m_Particles.Size();
+
+	m_SortKeys.resize(count);
+	m_SortOrder.resize(count);
+
+	m_JobSystem.ParallelFor(0, count, m_ChunkSize, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			m_SortKeys[i] = m_Grid.MortonCode(m_Particles.Pos(i));
+			m_SortOrder[i] = static_cast<uint32_t>(i);
+		}
+	});
+
+	// Stable, particles sharing a cell keep their order and the permutation stays deterministic
+	eng::RadixSort(m_JobSystem, m_SortKeys, m_SortOrder, 30);
+
+	m_Particles.Reorder(m_SortOrder, m_JobSystem);
+
+	// Pairs refer to indices
+	m_Neighbours.Invalidate();
+}
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <JobSystem.h>
+#include <RadixSort.h>
+
+#include "NeighbourList.h"
+#include "ParticleStore.h"
+#include "SpatialGrid.h"
+#include "SphKernels.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <random>
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#include <glm/glm.hpp>
+
+// How the pressure of a step is found
+enum class PressureModel : uint8_t {
+	// Weakly compressible, pressure grows with the density difference times the stiffness
+	Stiffness = 0,
+
+	// Predictive-corrective (PCISPH), iterates the pressure until the density error is below the tolerance
+	Pcisph,
+
+	// Position based fluids (PBF), replaces the force step with a fixed number of density constraint projections
+	Pbf
+};
+
+// Settings of a run, filled from the UI by the Simulation script or from the command line by the headless runner
+struct SimulationParams {
+	int particleCount = 1000;
+
+	// Mean spawn velocity, every particle gets up to +-1 on each axis on top
+	glm::dvec3 startVelocity{ 0.0 };
+
+	bool gravity = true;
+	bool collisions = true;
+
+	double restDensity = 5.0;
+	double viscosity = 0.1;
+	double stiffness = 3;
+	double damping = 0.98;
+
+	// 0 picks one thread per physical core
+	uint32_t threadCount = 0;
+
+	// Scales the box and the spawn volume, keeps the particle spacing for larger counts
+	double boxScale = 1.0;
+
+	PressureModel pressureModel = PressureModel::Stiffness;
+
+	// Pcisph only - mean compression of the compressed particles left after the solve, relative to the rest density,
+	// and the iteration cap
+	double densityTolerance = 0.01;
+	int maxPressureIterations = 8;
+
+	// Pbf only - constraint projections per step, trades quality for time
+	int pbfIterations = 4;
+};
+
+// Iterations and remaining mean compression of the compressed particles after the last pressure solve, zero for the stiffness model
+struct PressureSolveReport {
+	uint32_t iterations = 0;
+	double densityError = 0.0;
+};
+
+// Time spent per phase of FluidSolver::Update, summed over the steps since the last ResetStats
+struct SolverStats {
+	size_t steps = 0;
+
+	double reorderSeconds = 0.0;
+	double neighbourSeconds = 0.0;
+	double densitySeconds = 0.0;
+	double forceSeconds = 0.0;
+	double pressureSeconds = 0.0;
+	double integrationSeconds = 0.0;
+
+	// Iterations of the incompressible pressure solve
+	size_t pressureIterations = 0;
+
+	// Pairs visited by the density and force passes
+	size_t pairsEvaluated = 0;
+};
+
+//
+// Particle solver without any render dependency.
+// The Simulation script drives it inside the renderer, the headless runner and the bench drive it directly.
+//
+class FluidSolver {
+public:
+	// Spawns params.particleCount particles in the spawn volume, replaces the current ones
+	void Start(const SimulationParams& params);
+
+	// Fills particles with the spawn of Start, backends that keep their own particles start from it too
+	static void Spawn(const SimulationParams& params, ParticleStore& particles);
+
+	// params.boxScale that spawns particleCount particles as densely as s_BaseParticleCount in the default box
+	static double BoxScaleFor(int particleCount);
+
+	// Advances the particles by dt, parameters that changed since the last step are picked up
+	void Update(const SimulationParams& params, double dt);
+
+	inline const ParticleStore& GetParticles() const { return m_Particles; }
+	inline const NeighbourList& GetNeighbours() const { return m_Neighbours; }
+	inline eng::JobSystem& GetJobSystem() { return m_JobSystem; }
+
+	// Pair kernels of this solver, the widest the CPU supports unless set lower
+	inline void SetSimdLevel(eng::SimdLevel level) { m_PairKernels.SetSimdLevel(level); }
+	inline eng::SimdLevel GetSimdLevel() const { return m_PairKernels.GetSimdLevel(); }
+
+	inline const SolverStats& GetStats() const { return m_Stats; }
+	inline const PressureSolveReport& GetPressureReport() const { return m_PressureReport; }
+	inline void ResetStats() { m_Stats = SolverStats{}; }
+
+	// Bytes held by the particles, the grid and the neighbour list
+	size_t MemoryFootprint() const;
+
+	static constexpr double s_Gravity = 9.8;
+
+	// Particles the default box holds, larger counts grow the box
+	static constexpr int s_BaseParticleCount = 2500;
+
+	// Smoothing kernels of every pass, the support is 2 * m_ParticleRadius. Swapping the set here
+	// rebuilds the pair loops with its coefficients, PairKernels instantiates the sets of SphKernels.h.
+	// shader.comp has its own copy of StandardKernels.
+	using Kernels = StandardKernels;
+
+	// Squared speed of sound per unit of stiffness, the stiffness model's pressure grows with it
+	static constexpr double s_StiffnessScale = 400.0;
+
+	// Kinematic viscosity per unit of the viscosity setting
+	static constexpr double s_ViscosityScale = 5.0;
+
+private:
+	// Reflects particle i off the walls of the simulation box
+	void ApplyBoundary(size_t i);
+
+	// PCISPH - adds the velocity change from pressure to deltaVel. Expects deltaVel to hold every
+	// other change of the step except gravity, leaves the predicted density in the density stream.
+	void SolvePressure(double dt, double gravityDv);
+
+	// PBF - the whole step after the neighbour update. Projects the predicted positions onto the
+	// density constraint, takes the velocity from the motion and smooths it with XSPH viscosity.
+	void StepPbf(double dt, double gravityDv);
+
+	// Sorts the particle streams by the Morton code of their cell, so pairs are close in memory
+	void ReorderParticles();
+
+	// Mean of the compression the pressure passes left in m_ChunkCompression, over the compressed particles only.
+	// Most particles of a resting fluid sit at or below rest density and would hide the compressed ones.
+	double MeanCompression() const;
+
+	SimulationParams m_Params;
+	SolverStats m_Stats;
+	PressureSolveReport m_PressureReport;
+
+	// Constants - Particles
+	const double m_ParticleRadius = 1.0;
+	//const double m_ParticleMass = 18.0;
+	//const double m_ParticleGasConstant = 461.5;
+
+	// A particle on a lattice of spacing radius is at rest density, which gives the particle mass.
+	// The rest spacing is fixed by that, the rest density only sets the units.
+	const RestLattice m_RestLattice = MakeRestLattice<Kernels>(m_ParticleRadius);
+
+	// Constants - Simulation
+	const double m_SimulationWidth = 20.0;
+	const double m_SimulationHeight = 20.0;
+	const double m_SimulationDepth = 20.0;
+
+	// Constants - Spawn
+	static constexpr double s_XSpanS = 2;
+	static constexpr double s_XSpanE = 18;
+	static constexpr double s_YSpanS = 2;
+	static constexpr double s_YSpanE = 18;
+	static constexpr double s_ZSpanS = 10;
+	static constexpr double s_ZSpanE = 18;
+
+	// Box after params.boxScale, the walls are at 0 and at m_BoxSize
+	glm::dvec3 m_BoxSize{ m_SimulationWidth, m_SimulationDepth, m_SimulationHeight };
+
+	// Particle data
+	ParticleStore m_Particles;
+
+	// Neighbour search
+	SpatialGrid m_Grid;
+	NeighbourList m_Neighbours;
+
+	PairKernels m_PairKernels;
+
+	// Largest margin added to the interaction range of the neighbour list, trades rebuilds for extra pairs.
+	// The list sizes the margin from the speed of the particles below that.
+	double m_MaxNeighbourSkin = 0.5 * Kernels::s_Support;
+
+	// Steps between two Morton reorders
+	size_t m_ReorderInterval = 64;
+	size_t m_StepsSinceReorder = 0;
+	std::vector<uint32_t> m_SortKeys;
+	std::vector<uint32_t> m_SortOrder;
+
+	// Threading - 0 threads picks one per physical core
+	eng::JobSystem m_JobSystem{ 0 };
+	uint32_t m_ThreadCount = 0;
+	size_t m_ChunkSize = 256;
+
+	// Compression summed per chunk of m_ChunkSize particles, the chunks of a pass run in parallel
+	struct CompressionSum {
+		double sum = 0.0;
+		size_t count = 0;
+	};
+	std::vector<CompressionSum> m_ChunkCompression;
+
+	// Pairs evaluated per kernel call, the per-pair results stay on the stack
+	static constexpr size_t s_PairTile = 256;
+
+	// Furthest the pressure solve moves a particle in one step, in particle radii
+	static constexpr double s_MaxPressureShift = 0.5;
+
+	// Softens the PBF constraints, relative to the gradient sum of a particle at rest
+	static constexpr double s_PbfRelaxation = 0.1;
+
+	// Grid blocks handed out per job in the pair pass, a block already holds a few hundred pairs
+	size_t m_BlockChunkSize = 4;
+};
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "NeighbourList.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+void NeighbourList::SetCutoff(double cutoff, double maxSkin) {
+	m_Cutoff = cutoff;
+	m_MaxSkin = maxSkin;
+	m_Skin = 0.0;
+	m_Valid = false;
+}
+
+bool NeighbourList::Update(const ParticleStore& particles, SpatialGrid& grid, eng::JobSystem& jobSystem, double dt) {
+	m_StepCount++;
+
+	const bool rebuild = !m_Valid || NeedsRebuild(particles, jobSystem);
+	if (rebuild)
+		Rebuild(particles, grid, jobSystem, dt);
+
+	// Every pass of the step reads these instead of measuring the pair again
+	const double* posX = particles.posX.data();
+	const double* posY = particles.posY.data();
+	const double* posZ = particles.posZ.data();
+
+	jobSystem.ParallelFor(0, m_Blocks.size(), 4, [&](size_t begin, size_t end) {
+		for (size_t b = begin; b < end; b++) {
+			PairBlock& block = m_Blocks[b];
+
+			for (size_t p = 0; p < block.first.size(); p++) {
+				const uint32_t i = block.first[p];
+				const uint32_t j = block.second[p];
+
+				const double dx = posX[i] - posX[j];
+				const double dy = posY[i] - posY[j];
+				const double dz = posZ[i] - posZ[j];
+
+				block.distance[p] = std::sqrt(dx * dx + dy * dy + dz * dz);
+			}
+		}
+	});
+
+	return rebuild;
+}
+
+size_t NeighbourList::PairCount() const {
+	size_t count = 0;
+	for (const PairBlock& block : m_Blocks)
+		count += block.first.size();
+
+	return count;
+}
+
+size_t NeighbourList::MemoryFootprint() const {
+	size_t bytes = (m_RefPosX.capacity() + m_RefPosY.capacity() + m_RefPosZ.capacity()) * sizeof(double);
+
+	for (const PairBlock& block : m_Blocks)
+		bytes += (block.first.capacity() + block.second.capacity()) * sizeof(uint32_t) + block.distance.capacity() * sizeof(double);
+
+	return bytes;
+}
+
+bool NeighbourList::NeedsRebuild(const ParticleStore& particles, eng::JobSystem& jobSystem) const {
+	const size_t count = particles.Size();
+
+	if (m_RefPosX.size() != count)
+		return true;
+
+	// Two particles closing in on each other can each use up half the skin
+	const double maxDisplacementSq = 0.25 * m_Skin * m_Skin;
+	std::atomic<bool> moved{ false };
+
+	jobSystem.ParallelFor(0, count, [&](size_t begin, size_t end) {
+		if (moved.load(std::memory_order_relaxed))
+			return;
+
+		for (size_t i = begin; i < end; i++) {
+			const double dx = particles.posX[i] - m_RefPosX[i];
+			const double dy = particles.posY[i] - m_RefPosY[i];
+			const double dz = particles.posZ[i] - m_RefPosZ[i];
+
+			if (dx * dx + dy * dy + dz * dz > maxDisplacementSq) {
+				moved.store(true, std::memory_order_relaxed);
+				return;
+			}
+		}
+	});
+
+	return moved.load(std::memory_order_relaxed);
+}
+
+void NeighbourList::Rebuild(const ParticleStore& particles, SpatialGrid& grid, eng::JobSystem& jobSystem, double dt) {
+	const size_t count = particles.Size();
+	const size_t chunkSize = jobSystem.GetChunkSize();
+
+	// Fastest particle, one maximum per chunk
+	m_ChunkMaxSpeedSq.assign((count + chunkSize - 1) / chunkSize, 0.0);
+
+	jobSystem.ParallelFor(0, count, chunkSize, [&](size_t begin, size_t end) {
+		double maxSpeedSq = 0.0;
+
+		for (size_t i = begin; i < end; i++)
+			maxSpeedSq = std::max(maxSpeedSq, particles.velX[i] * particles.velX[i] + particles.velY[i] * particles.velY[i] + particles.velZ[i] * particles.velZ[i]);
+
+		m_ChunkMaxSpeedSq[begin / chunkSize] = maxSpeedSq;
+	});
+
+	const double maxSpeedSq = m_ChunkMaxSpeedSq.empty() ? 0.0 : *std::max_element(m_ChunkMaxSpeedSq.begin(), m_ChunkMaxSpeedSq.end());
+
+	// Two particles closing in use up the skin twice as fast as one. The skin is the largest of a few levels
+	// that still lasts s_TargetSteps, so the grid only refits its cells when the level changes.
+	const double displacement = 2.0 * std::sqrt(maxSpeedSq) * dt;
+
+	double skin = m_MaxSkin;
+	for (int level = 1; level < s_SkinLevels && skin > s_TargetSteps * displacement; level++)
+		skin *= 0.5;
+
+	// A skin that doesn't last long enough only adds pairs, the list is rebuilt every step without one then
+	m_Skin = skin >= s_MinSkinSteps * displacement ? skin : 0.0;
+
+	grid.SetCellSize(m_Cutoff + m_Skin);
+	grid.Build(count, [&](size_t i) { return particles.Pos(i); });
+
+	// Block layout only changes with the grid dimensions
+	size_t blockCount = 0;
+	for (int colour = 0; colour < SpatialGrid::s_ColourCount; colour++) {
+		m_ColourStart[colour] = blockCount;
+		blockCount += grid.GetColourBlocks(colour).size();
+	}
+	m_ColourStart[SpatialGrid::s_ColourCount] = blockCount;
+
+	m_Blocks.resize(blockCount);
+
+	const double rangeSq = (m_Cutoff + m_Skin) * (m_Cutoff + m_Skin);
+
+	for (int colour = 0; colour < SpatialGrid::s_ColourCount; colour++) {
+		const std::vector<glm::ivec3>& bases = grid.GetColourBlocks(colour);
+		const size_t first = m_ColourStart[colour];
+
+		jobSystem.ParallelFor(0, bases.size(), 4, [&](size_t begin, size_t end) {
+			for (size_t b = begin; b < end; b++) {
+				PairBlock& block = m_Blocks[first + b];
+				block.first.clear();
+				block.second.clear();
+
+				grid.ForEachPairInBlock(bases[b], [&](size_t i, size_t j) {
+					const double dx = particles.posX[i] - particles.posX[j];
+					const double dy = particles.posY[i] - particles.posY[j];
+					const double dz = particles.posZ[i] - particles.posZ[j];
+
+					if (dx * dx + dy * dy + dz * dz >= rangeSq)
+						return;
+
+					block.first.push_back(static_cast<uint32_t>(i));
+					block.second.push_back(static_cast<uint32_t>(j));
+				});
+
+				block.distance.resize(block.first.size());
+			}
+		});
+	}
+
+	m_RefPosX.assign(particles.posX.begin(), particles.posX.end());
+	m_RefPosY.assign(particles.posY.begin(), particles.posY.end());
+	m_RefPosZ.assign(particles.posZ.begin(), particles.posZ.end());
+
+	m_Valid = true;
+	m_RebuildCount++;
+}
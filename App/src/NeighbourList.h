@@ -0,0 +1,111 @@
+#pragma once
+
+#include <JobSystem.h>
+
+#include "PairKernels.h"
+#include "ParticleStore.h"
+#include "SpatialGrid.h"
+
+#include <cstdint>
+#include <vector>
+
+//
+// Verlet list of the particle pairs within interaction range plus a skin.
+// Pairs are kept per grid block in colour order, so passes over the list
+// inherit the race-free schedule of SpatialGrid::ForEachPairInBlock.
+// The list only has to be rebuilt once a particle moved more than half the skin.
+// The skin is picked at every rebuild from the fastest particle, out of maxSkin and a few halvings of it,
+// so the list lasts a few steps when the particles are slow and costs no extra pairs when they are fast.
+// Only a change of that level refits the grid cells.
+//
+class NeighbourList {
+public:
+	// Pairs closer than cutoff + skin are listed, the skin is 0, maxSkin or a halving of it
+	void SetCutoff(double cutoff, double maxSkin);
+
+	// Forces a rebuild on the next Update, needed whenever particles are added, removed or reordered
+	inline void Invalidate() { m_Valid = false; }
+
+	// Rebuilds the list from the grid when needed and refreshes the pair distances. A rebuild picks
+	// the skin for steps of dt and refits the grid cells to cutoff + skin when it changed. Returns true when the list was rebuilt.
+	bool Update(const ParticleStore& particles, SpatialGrid& grid, eng::JobSystem& jobSystem, double dt);
+
+	// Calls func(i, j, distance) for every listed pair, blocks of one colour run in parallel
+	template<typename Func>
+	void ForEachPair(eng::JobSystem& jobSystem, size_t blockChunkSize, Func&& func) const {
+		for (int colour = 0; colour < SpatialGrid::s_ColourCount; colour++) {
+			jobSystem.ParallelFor(m_ColourStart[colour], m_ColourStart[colour + 1], blockChunkSize, [&](size_t begin, size_t end) {
+				for (size_t b = begin; b < end; b++) {
+					const PairBlock& block = m_Blocks[b];
+
+					for (size_t p = 0; p < block.first.size(); p++)
+						func(static_cast<size_t>(block.first[p]), static_cast<size_t>(block.second[p]), block.distance[p]);
+				}
+			});
+		}
+	}
+
+	// Calls func(pairs) with the PairSpan of every block, blocks of one colour run in parallel
+	template<typename Func>
+	void ForEachBlock(eng::JobSystem& jobSystem, size_t blockChunkSize, Func&& func) const {
+		for (int colour = 0; colour < SpatialGrid::s_ColourCount; colour++) {
+			jobSystem.ParallelFor(m_ColourStart[colour], m_ColourStart[colour + 1], blockChunkSize, [&](size_t begin, size_t end) {
+				for (size_t b = begin; b < end; b++) {
+					const PairBlock& block = m_Blocks[b];
+
+					if (!block.first.empty())
+						func(PairSpan{ block.first.data(), block.second.data(), block.distance.data(), block.first.size() });
+				}
+			});
+		}
+	}
+
+	inline double GetCutoff() const { return m_Cutoff; }
+	inline double GetSkin() const { return m_Skin; }
+	inline double GetMaxSkin() const { return m_MaxSkin; }
+
+	// Number of rebuilds and of Update calls since the list was created
+	inline size_t GetRebuildCount() const { return m_RebuildCount; }
+	inline size_t GetStepCount() const { return m_StepCount; }
+
+	size_t PairCount() const;
+
+	// Bytes held by the pair and reference position arrays
+	size_t MemoryFootprint() const;
+
+private:
+	bool NeedsRebuild(const ParticleStore& particles, eng::JobSystem& jobSystem) const;
+	void Rebuild(const ParticleStore& particles, SpatialGrid& grid, eng::JobSystem& jobSystem, double dt);
+
+	struct PairBlock {
+		std::vector<uint32_t> first;
+		std::vector<uint32_t> second;
+		std::vector<double> distance;
+	};
+
+	double m_Cutoff = 2.0;
+	double m_Skin = 0.0;
+	double m_MaxSkin = 1.0;
+	bool m_Valid = false;
+
+	// Steps a list should last with the particles at their speed of the rebuild, and the fewest it may last.
+	// The skin's extra pairs are paid for on every step, a list that lasts fewer steps costs more than it saves.
+	static constexpr double s_TargetSteps = 8.0;
+	static constexpr double s_MinSkinSteps = 4.0;
+
+	// The skin is maxSkin or one of its halvings, at most this many levels
+	static constexpr int s_SkinLevels = 4;
+
+	size_t m_RebuildCount = 0;
+	size_t m_StepCount = 0;
+
+	// Blocks in colour order, blocks of colour c are in [m_ColourStart[c], m_ColourStart[c + 1])
+	std::vector<PairBlock> m_Blocks;
+	size_t m_ColourStart[SpatialGrid::s_ColourCount + 1] = {};
+
+	// Fastest particle per chunk of the rebuild
+	std::vector<double> m_ChunkMaxSpeedSq;
+
+	// Positions at the last rebuild
+	AlignedVector<double> m_RefPosX, m_RefPosY, m_RefPosZ;
+};
@@ -0,0 +1,83 @@
+#include "PairKernels.h"
+
+#include "SphKernels.h"
+
+#include <algorithm>
+
+PairKernels::PairKernels(eng::SimdLevel level)
+	: m_Level(std::min(level, eng::CpuFeatures::GetSimdLevel())) {}
+
+void PairKernels::SetSimdLevel(eng::SimdLevel level) {
+	m_Level = std::min(level, eng::CpuFeatures::GetSimdLevel());
+}
+
+// The vector kernels evaluate the same expressions in the same order, keep them in sync
+template<typename Kernel>
+void PairKernels::DensitiesRange(const PairSpan& pairs, size_t begin, double* weight) {
+	for (size_t p = begin; p < pairs.count; p++) {
+		const double distance = pairs.distance[p];
+		weight[p] = Kernel::Value(distance, distance * distance);
+	}
+}
+
+template<typename Kernels>
+void PairKernels::PairForcesRange(const ParticleStore& particles, const PairSpan& pairs, size_t begin, const PairForceParams& params, double* deltaVelX, double* deltaVelY, double* deltaVelZ) {
+	const double* posX = particles.posX.data();
+	const double* posY = particles.posY.data();
+	const double* posZ = particles.posZ.data();
+	const double* velX = particles.velX.data();
+	const double* velY = particles.velY.data();
+	const double* velZ = particles.velZ.data();
+	const double* density = particles.density.data();
+	const double* pressure = particles.pressure.data();
+
+	// Switched off collisions touch nothing, the loop stays the same
+	const double collisionRange = params.collisions ? params.radius : 0.0;
+	const double minDistance = KernelMath::s_MinDistanceRatio * Kernels::s_Support;
+	const double pressureCoef = params.mass * params.dt * params.damping;
+	const double viscosityCoef = params.viscosity * params.restDensity * params.mass * params.dt * params.damping;
+
+	for (size_t p = begin; p < pairs.count; p++) {
+		const double distance = pairs.distance[p];
+
+		const uint32_t i = pairs.first[p];
+		const uint32_t j = pairs.second[p];
+
+		const double dirX = posX[j] - posX[i];
+		const double dirY = posY[j] - posY[i];
+		const double dirZ = posZ[j] - posZ[i];
+
+		const double relX = velX[i] - velX[j];
+		const double relY = velY[i] - velY[j];
+		const double relZ = velZ[i] - velZ[j];
+
+		// Coincident particles have no direction, their normal is zero instead of infinite
+		const double invDist = 1.0 / std::max(distance, minDistance);
+
+		// Collision impulse, cancels the approaching normal velocity of both particles
+		const double normalX = -dirX * invDist;
+		const double normalY = -dirY * invDist;
+		const double normalZ = -dirZ * invDist;
+
+		const double normalVel = relX * normalX + relY * normalY + relZ * normalZ;
+		const double impulse = distance < collisionRange && normalVel < 0.0 ? -normalVel : 0.0;
+
+		// Densities never drop below the particle itself, one division covers both
+		const double invDensityProduct = 1.0 / (density[i] * density[j]);
+		const double invDensityI = density[j] * invDensityProduct;
+		const double invDensityJ = density[i] * invDensityProduct;
+
+		// Symmetric pressure gradient along the pair, and viscosity along the velocity difference
+		const double pressureScale = pressureCoef * (pressure[i] * (invDensityI * invDensityI) + pressure[j] * (invDensityJ * invDensityJ)) * Kernels::Pressure::GradientScale(distance);
+		const double viscosityScale = viscosityCoef * invDensityProduct * Kernels::Viscosity::Laplacian(distance);
+
+		deltaVelX[p] = impulse * normalX + pressureScale * dirX - viscosityScale * relX;
+		deltaVelY[p] = impulse * normalY + pressureScale * dirY - viscosityScale * relY;
+		deltaVelZ[p] = impulse * normalZ + pressureScale * dirZ - viscosityScale * relZ;
+	}
+}
+
+template void PairKernels::DensitiesRange<StandardKernels::Density>(const PairSpan&, size_t, double*);
+template void PairKernels::DensitiesRange<WendlandKernels::Density>(const PairSpan&, size_t, double*);
+template void PairKernels::PairForcesRange<StandardKernels>(const ParticleStore&, const PairSpan&, size_t, const PairForceParams&, double*, double*, double*);
+template void PairKernels::PairForcesRange<WendlandKernels>(const ParticleStore&, const PairSpan&, size_t, const PairForceParams&, double*, double*, double*);
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <CpuFeatures.h>
+
+#include "ParticleStore.h"
+
+#include <cstdint>
+
+// MSVC exposes every intrinsic without /arch, GCC and Clang need the target on the function
+#if defined(__GNUC__) || defined(__clang__)
+#define FS_SIMD_TARGET(isa) __attribute__((target(isa)))
+#else
+#define FS_SIMD_TARGET(isa)
+#endif
+
+// Constants of the pair force, shared by every pair of a step
+struct PairForceParams {
+	double radius = 1.0;
+	double mass = 1.0;
+	double restDensity = 5.0;
+	double viscosity = 0.1;
+	double damping = 0.98;
+	double dt = 0.0;
+	bool collisions = true;
+};
+
+// Pairs handed to a kernel, indices into the particle streams plus the measured distance
+struct PairSpan {
+	const uint32_t* first = nullptr;
+	const uint32_t* second = nullptr;
+	const double* distance = nullptr;
+	size_t count = 0;
+
+	// Pairs [offset, offset + maxCount) clamped to the span
+	inline PairSpan Slice(size_t offset, size_t maxCount) const {
+		const size_t sliceCount = offset < count ? (count - offset < maxCount ? count - offset : maxCount) : 0;
+		return PairSpan{ first + offset, second + offset, distance + offset, sliceCount };
+	}
+};
+
+//
+// Per-pair math of the density and force passes over SoA data, instantiated per kernel from SphKernels.h.
+// Each kernel exists as scalar, AVX2 (4 pairs per instruction) and AVX-512 (8 pairs),
+// every instance picks its level at runtime once per call. Results are written
+// per pair, the caller scatters them to the particles.
+//
+class PairKernels {
+public:
+	// Runs the kernels of the given level, clamped to what the CPU supports
+	explicit PairKernels(eng::SimdLevel level = eng::CpuFeatures::GetSimdLevel());
+
+	// Density kernel weight of every pair, zero from the support on
+	template<typename Kernel>
+	void Densities(const PairSpan& pairs, double* weight) const;
+
+	// Velocity change of the first particle of every pair from collision, pressure and viscosity,
+	// the second particle gets the negated value. Reads the density and pressure streams.
+	// Zero for pairs out of range, finite for coincident ones.
+	template<typename Kernels>
+	void PairForces(const ParticleStore& particles, const PairSpan& pairs, const PairForceParams& params, double* deltaVelX, double* deltaVelY, double* deltaVelZ) const;
+
+	// Picks the kernels of the given level, clamped to what the CPU supports
+	void SetSimdLevel(eng::SimdLevel level);
+	inline eng::SimdLevel GetSimdLevel() const { return m_Level; }
+
+private:
+	// Scalar code for the pairs [begin, pairs.count), used for the tails of the vector kernels
+	template<typename Kernel>
+	static void DensitiesRange(const PairSpan& pairs, size_t begin, double* weight);
+	template<typename Kernel>
+	static void DensitiesAvx2(const PairSpan& pairs, double* weight);
+	template<typename Kernel>
+	static void DensitiesAvx512(const PairSpan& pairs, double* weight);
+
+	template<typename Kernels>
+	static void PairForcesRange(const ParticleStore& particles, const PairSpan& pairs, size_t begin, const PairForceParams& params, double* deltaVelX, double* deltaVelY, double* deltaVelZ);
+	template<typename Kernels>
+	static void PairForcesAvx2(const ParticleStore& particles, const PairSpan& pairs, const PairForceParams& params, double* deltaVelX, double* deltaVelY, double* deltaVelZ);
+	template<typename Kernels>
+	static void PairForcesAvx512(const ParticleStore& particles, const PairSpan& pairs, const PairForceParams& params, double* deltaVelX, double* deltaVelY, double* deltaVelZ);
+
+	eng::SimdLevel m_Level;
+};
+
+// The kernel sets of SphKernels.h are instantiated in PairKernels.cpp and the ISA files, others won't link
+
+template<typename Kernel>
+inline void PairKernels::Densities(const PairSpan& pairs, double* weight) const {
+	switch (m_Level) {
+	case eng::SimdLevel::AVX512:
+		DensitiesAvx512<Kernel>(pairs, weight);
+		break;
+	case eng::SimdLevel::AVX2:
+		DensitiesAvx2<Kernel>(pairs, weight);
+		break;
+	default:
+		DensitiesRange<Kernel>(pairs, 0, weight);
+		break;
+	}
+}
+
+template<typename Kernels>
+inline void PairKernels::PairForces(const ParticleStore& particles, const PairSpan& pairs, const PairForceParams& params, double* deltaVelX, double* deltaVelY, double* deltaVelZ) const {
+	switch (m_Level) {
+	case eng::SimdLevel::AVX512:
+		PairForcesAvx512<Kernels>(particles, pairs, params, deltaVelX, deltaVelY, deltaVelZ);
+		break;
+	case eng::SimdLevel::AVX2:
+		PairForcesAvx2<Kernels>(particles, pairs, params, deltaVelX, deltaVelY, deltaVelZ);
+		break;
+	default:
+		PairForcesRange<Kernels>(particles, pairs, 0, params, deltaVelX, deltaVelY, deltaVelZ);
+		break;
+	}
+}
\ No newline at end of file
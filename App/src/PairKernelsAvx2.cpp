@@ -0,0 +1,101 @@
+#include "PairKernels.h"
+
+#include "SphKernels.h"
+
+#include <immintrin.h>
+
+// 4 pairs per iteration, the remainder goes through the scalar code.
+// Lanes are loaded one by one instead of with vgatherdpd, which is microcoded
+// and much slower on CPUs patched against Gather Data Sampling.
+
+FS_SIMD_TARGET("avx2")
+static inline __m256d Gather(const double* base, const uint32_t* index) {
+	return _mm256_set_pd(base[index[3]], base[index[2]], base[index[1]], base[index[0]]);
+}
+
+template<typename Kernel>
+FS_SIMD_TARGET("avx2")
+void PairKernels::DensitiesAvx2(const PairSpan& pairs, double* weight) {
+	size_t p = 0;
+	for (; p + 4 <= pairs.count; p += 4) {
+		const __m256d distance = _mm256_loadu_pd(pairs.distance + p);
+		_mm256_storeu_pd(weight + p, Kernel::Value(distance, _mm256_mul_pd(distance, distance)));
+	}
+
+	DensitiesRange<Kernel>(pairs, p, weight);
+}
+
+template<typename Kernels>
+FS_SIMD_TARGET("avx2")
+void PairKernels::PairForcesAvx2(const ParticleStore& particles, const PairSpan& pairs, const PairForceParams& params, double* deltaVelX, double* deltaVelY, double* deltaVelZ) {
+	const double* posX = particles.posX.data();
+	const double* posY = particles.posY.data();
+	const double* posZ = particles.posZ.data();
+	const double* velX = particles.velX.data();
+	const double* velY = particles.velY.data();
+	const double* velZ = particles.velZ.data();
+	const double* density = particles.density.data();
+	const double* pressure = particles.pressure.data();
+
+	const __m256d zero = _mm256_setzero_pd();
+	const __m256d one = _mm256_set1_pd(1.0);
+	const __m256d sign = _mm256_set1_pd(-0.0);
+	const __m256d collisionRange = _mm256_set1_pd(params.collisions ? params.radius : 0.0);
+	const __m256d minDistance = _mm256_set1_pd(KernelMath::s_MinDistanceRatio * Kernels::s_Support);
+	const __m256d pressureCoef = _mm256_set1_pd(params.mass * params.dt * params.damping);
+	const __m256d viscosityCoef = _mm256_set1_pd(params.viscosity * params.restDensity * params.mass * params.dt * params.damping);
+
+	size_t p = 0;
+	for (; p + 4 <= pairs.count; p += 4) {
+		const uint32_t* first = pairs.first + p;
+		const uint32_t* second = pairs.second + p;
+
+		const __m256d distance = _mm256_loadu_pd(pairs.distance + p);
+
+		const __m256d dirX = _mm256_sub_pd(Gather(posX, second), Gather(posX, first));
+		const __m256d dirY = _mm256_sub_pd(Gather(posY, second), Gather(posY, first));
+		const __m256d dirZ = _mm256_sub_pd(Gather(posZ, second), Gather(posZ, first));
+
+		const __m256d relX = _mm256_sub_pd(Gather(velX, first), Gather(velX, second));
+		const __m256d relY = _mm256_sub_pd(Gather(velY, first), Gather(velY, second));
+		const __m256d relZ = _mm256_sub_pd(Gather(velZ, first), Gather(velZ, second));
+
+		const __m256d invDist = _mm256_div_pd(one, _mm256_max_pd(distance, minDistance));
+
+		const __m256d normalX = _mm256_mul_pd(_mm256_xor_pd(dirX, sign), invDist);
+		const __m256d normalY = _mm256_mul_pd(_mm256_xor_pd(dirY, sign), invDist);
+		const __m256d normalZ = _mm256_mul_pd(_mm256_xor_pd(dirZ, sign), invDist);
+
+		const __m256d normalVel = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(relX, normalX), _mm256_mul_pd(relY, normalY)), _mm256_mul_pd(relZ, normalZ));
+		const __m256d collide = _mm256_and_pd(_mm256_cmp_pd(distance, collisionRange, _CMP_LT_OQ), _mm256_cmp_pd(normalVel, zero, _CMP_LT_OQ));
+		const __m256d impulse = _mm256_and_pd(_mm256_xor_pd(normalVel, sign), collide);
+
+		const __m256d densityI = Gather(density, first);
+		const __m256d densityJ = Gather(density, second);
+		const __m256d invDensityProduct = _mm256_div_pd(one, _mm256_mul_pd(densityI, densityJ));
+		const __m256d invDensityI = _mm256_mul_pd(densityJ, invDensityProduct);
+		const __m256d invDensityJ = _mm256_mul_pd(densityI, invDensityProduct);
+
+		const __m256d pressureSum = _mm256_add_pd(
+			  _mm256_mul_pd(Gather(pressure, first), _mm256_mul_pd(invDensityI, invDensityI))
+			, _mm256_mul_pd(Gather(pressure, second), _mm256_mul_pd(invDensityJ, invDensityJ)));
+
+		const __m256d pressureScale = _mm256_mul_pd(_mm256_mul_pd(pressureCoef, pressureSum), Kernels::Pressure::GradientScale(distance));
+		const __m256d viscosityScale = _mm256_mul_pd(_mm256_mul_pd(viscosityCoef, invDensityProduct), Kernels::Viscosity::Laplacian(distance));
+
+		const __m256d dvX = _mm256_sub_pd(_mm256_add_pd(_mm256_mul_pd(impulse, normalX), _mm256_mul_pd(pressureScale, dirX)), _mm256_mul_pd(viscosityScale, relX));
+		const __m256d dvY = _mm256_sub_pd(_mm256_add_pd(_mm256_mul_pd(impulse, normalY), _mm256_mul_pd(pressureScale, dirY)), _mm256_mul_pd(viscosityScale, relY));
+		const __m256d dvZ = _mm256_sub_pd(_mm256_add_pd(_mm256_mul_pd(impulse, normalZ), _mm256_mul_pd(pressureScale, dirZ)), _mm256_mul_pd(viscosityScale, relZ));
+
+		_mm256_storeu_pd(deltaVelX + p, dvX);
+		_mm256_storeu_pd(deltaVelY + p, dvY);
+		_mm256_storeu_pd(deltaVelZ + p, dvZ);
+	}
+
+	PairForcesRange<Kernels>(particles, pairs, p, params, deltaVelX, deltaVelY, deltaVelZ);
+}
+
+template void PairKernels::DensitiesAvx2<StandardKernels::Density>(const PairSpan&, double*);
+template void PairKernels::DensitiesAvx2<WendlandKernels::Density>(const PairSpan&, double*);
+template void PairKernels::PairForcesAvx2<StandardKernels>(const ParticleStore&, const PairSpan&, const PairForceParams&, double*, double*, double*);
+template void PairKernels::PairForcesAvx2<WendlandKernels>(const ParticleStore&, const PairSpan&, const PairForceParams&, double*, double*, double*);
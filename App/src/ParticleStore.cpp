@@ -0,0 +1,91 @@
+#include "ParticleStore.h"
+
+void ParticleStore::Resize(size_t count) {
+	posX.resize(count, 0.0);
+	posY.resize(count, 0.0);
+	posZ.resize(count, 0.0);
+
+	velX.resize(count, 0.0);
+	velY.resize(count, 0.0);
+	velZ.resize(count, 0.0);
+
+	density.resize(count, 0.0);
+	pressure.resize(count, 0.0);
+
+	deltaVelX.resize(count, 0.0);
+	deltaVelY.resize(count, 0.0);
+	deltaVelZ.resize(count, 0.0);
+
+	predPosX.resize(count, 0.0);
+	predPosY.resize(count, 0.0);
+	predPosZ.resize(count, 0.0);
+
+	pressureVelX.resize(count, 0.0);
+	pressureVelY.resize(count, 0.0);
+	pressureVelZ.resize(count, 0.0);
+
+	deltaPosX.resize(count, 0.0);
+	deltaPosY.resize(count, 0.0);
+	deltaPosZ.resize(count, 0.0);
+
+	const size_t oldCount = id.size();
+	id.resize(count);
+	slot.resize(count);
+
+	// Shrinking drops particles by index, the survivors are numbered again
+	const size_t firstNewId = count < oldCount ? 0 : oldCount;
+
+	for (size_t i = firstNewId; i < count; i++)
+		id[i] = static_cast<uint32_t>(i);
+
+	for (size_t i = firstNewId; i < count; i++)
+		slot[id[i]] = static_cast<uint32_t>(i);
+}
+
+void ParticleStore::Reorder(const std::vector<uint32_t>& order, eng::JobSystem& jobSystem) {
+	Permute(posX, m_Scratch, order, jobSystem);
+	Permute(posY, m_Scratch, order, jobSystem);
+	Permute(posZ, m_Scratch, order, jobSystem);
+
+	Permute(velX, m_Scratch, order, jobSystem);
+	Permute(velY, m_Scratch, order, jobSystem);
+	Permute(velZ, m_Scratch, order, jobSystem);
+
+	Permute(density, m_Scratch, order, jobSystem);
+	Permute(pressure, m_Scratch, order, jobSystem);
+
+	Permute(id, m_IdScratch, order, jobSystem);
+
+	jobSystem.ParallelFor(0, id.size(), [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++)
+			slot[id[i]] = static_cast<uint32_t>(i);
+	});
+}
+
+template<typename T>
+void ParticleStore::Permute(AlignedVector<T>& stream, AlignedVector<T>& scratch, const std::vector<uint32_t>& order, eng::JobSystem& jobSystem) {
+	scratch.resize(stream.size());
+
+	jobSystem.ParallelFor(0, stream.size(), [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++)
+			scratch[i] = stream[order[i]];
+	});
+
+	stream.swap(scratch);
+}
+
+void ParticleStore::Clear() {
+	Resize(0);
+}
+
+size_t ParticleStore::MemoryFootprint() const {
+	return (posX.capacity() + posY.capacity() + posZ.capacity()
+		  + velX.capacity() + velY.capacity() + velZ.capacity()
+		  + density.capacity() + pressure.capacity()
+		  + deltaVelX.capacity() + deltaVelY.capacity() + deltaVelZ.capacity()
+		  + predPosX.capacity() + predPosY.capacity() + predPosZ.capacity()
+		  + pressureVelX.capacity() + pressureVelY.capacity() + pressureVelZ.capacity()
+		  + deltaPosX.capacity() + deltaPosY.capacity() + deltaPosZ.capacity()
+		  + m_Scratch.capacity()) * sizeof(double)
+		 + (id.capacity() + slot.capacity() + m_IdScratch.capacity()) * sizeof(uint32_t);
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <JobSystem.h>
+
+//
+// Allocator that keeps every stream on its own cache line, so SIMD loads
+// never straddle lines and the compiler can assume aligned accesses.
+//
+template<typename T, size_t Alignment = 64>
+struct AlignedAllocator {
+	using value_type = T;
+
+	template<typename U>
+	struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+	AlignedAllocator() = default;
+
+	template<typename U>
+	AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+	T* allocate(size_t count) {
+		void* ptr = ::operator new(count * sizeof(T), std::align_val_t{ Alignment });
+		return static_cast<T*>(ptr);
+	}
+
+	void deallocate(T* ptr, size_t) {
+		::operator delete(ptr, std::align_val_t{ Alignment });
+	}
+
+	template<typename U>
+	bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+
+	template<typename U>
+	bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+template<typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+class ParticleStore;
+
+//
+// Thin handle to a particle inside a ParticleStore, lets per-particle code
+// keep reading like AoS while the data stays in separate streams.
+//
+class ParticleView {
+public:
+	ParticleView(ParticleStore& store, size_t index)
+		: m_Store(&store), m_Index(index) {}
+
+	inline glm::dvec3 Pos() const;
+	inline glm::dvec3 Vel() const;
+
+	inline void SetPos(const glm::dvec3& pos);
+	inline void SetVel(const glm::dvec3& vel);
+	inline void AddVel(const glm::dvec3& dv);
+
+	inline double& Density();
+	inline double& Pressure();
+
+	inline size_t Index() const { return m_Index; }
+
+private:
+	ParticleStore* m_Store;
+	size_t m_Index;
+};
+
+//
+// Structure-of-arrays storage for the simulation state.
+// Holds no render data, the link to the renderer lives in the Simulation.
+// Storage order may change (see Reorder), code outside the solver refers to particles by id.
+//
+class ParticleStore {
+public:
+	// New particles get ids following the existing ones
+	void Resize(size_t count);
+	void Clear();
+
+	// Moves particle order[i] to index i for every stream, ids move along with their particle.
+	// The force accumulators and the pressure solve scratch are left as they are, they are rebuilt every step.
+	void Reorder(const std::vector<uint32_t>& order, eng::JobSystem& jobSystem);
+
+	// Current index of the particle with the given id
+	inline size_t IndexOf(uint32_t particleId) const { return static_cast<size_t>(slot[particleId]); }
+
+	inline size_t Size() const { return posX.size(); }
+
+	inline ParticleView operator[](size_t i) { return ParticleView{ *this, i }; }
+
+	inline glm::dvec3 Pos(size_t i) const { return glm::dvec3{ posX[i], posY[i], posZ[i] }; }
+	inline glm::dvec3 Vel(size_t i) const { return glm::dvec3{ velX[i], velY[i], velZ[i] }; }
+
+	inline void SetPos(size_t i, const glm::dvec3& pos) { posX[i] = pos.x; posY[i] = pos.y; posZ[i] = pos.z; }
+	inline void SetVel(size_t i, const glm::dvec3& vel) { velX[i] = vel.x; velY[i] = vel.y; velZ[i] = vel.z; }
+	inline void AddVel(size_t i, const glm::dvec3& dv) { velX[i] += dv.x; velY[i] += dv.y; velZ[i] += dv.z; }
+
+	// Bytes held by all streams
+	size_t MemoryFootprint() const;
+
+	AlignedVector<double> posX, posY, posZ;
+	AlignedVector<double> velX, velY, velZ;
+	AlignedVector<double> density;
+	AlignedVector<double> pressure;
+
+	// Velocity change gathered by the force passes, applied during integration
+	AlignedVector<double> deltaVelX, deltaVelY, deltaVelZ;
+
+	// Scratch of the incompressible pressure solve, predicted positions and the velocity change from pressure
+	AlignedVector<double> predPosX, predPosY, predPosZ;
+	AlignedVector<double> pressureVelX, pressureVelY, pressureVelZ;
+
+	// Scratch of the PBF projection, position correction of one iteration
+	AlignedVector<double> deltaPosX, deltaPosY, deltaPosZ;
+
+	// Stable particle id per index and its inverse, index per id
+	AlignedVector<uint32_t> id;
+	AlignedVector<uint32_t> slot;
+
+private:
+	template<typename T>
+	void Permute(AlignedVector<T>& stream, AlignedVector<T>& scratch, const std::vector<uint32_t>& order, eng::JobSystem& jobSystem);
+
+	AlignedVector<double> m_Scratch;
+	AlignedVector<uint32_t> m_IdScratch;
+};
+
+inline glm::dvec3 ParticleView::Pos() const { return m_Store->Pos(m_Index); }
+inline glm::dvec3 ParticleView::Vel() const { return m_Store->Vel(m_Index); }
+
+inline void ParticleView::SetPos(const glm::dvec3& pos) { m_Store->SetPos(m_Index, pos); }
+inline void ParticleView::SetVel(const glm::dvec3& vel) { m_Store->SetVel(m_Index, vel); }
+inline void ParticleView::AddVel(const glm::dvec3& dv) { m_Store->AddVel(m_Index, dv); }
+
+inline double& ParticleView::Density() { return m_Store->density[m_Index]; }
+inline double& ParticleView::Pressure() { return m_Store->pressure[m_Index]; }
@@ -1,184 +1,145 @@
 #include "Simulation.h"
 
+#include "SolverRegistry.h"
+
 #include <Rnd/ORenderer.h>
 #include <Rnd/Time.h>
 #include <Rnd/UIHelper.h>
 
-double RandomDouble(double lowerBound, double upperBound) {
-	std::default_random_engine randEng(rand());
-	std::uniform_real_distribution<double> unifDist(lowerBound, upperBound);
-	return unifDist(randEng);
-}
-
+#include <algorithm>
+#include <string>
 
 void Simulation::Start() {
+	ListBackends();
+
 	int xVel, yVel, zVel;
-	rnd::UIHelper::ReadSimulationStartParams(xVel, yVel, zVel, m_NumberOfParticles);
+	rnd::UIHelper::ReadSimulationStartParams(xVel, yVel, zVel, m_Params.particleCount);
+	m_Params.startVelocity = glm::dvec3{ xVel, yVel, zVel };
+	m_Params.boxScale = FluidSolver::BoxScaleFor(m_Params.particleCount);
 
-	for (int i = 0; i < m_NumberOfParticles; i++) {
-		Particle particle{};
+	int backend, crossCheck;
+	rnd::UIHelper::ReadSolverBackends(backend, crossCheck);
 
-		particle.pos.x = RandomDouble(m_XSpanS, m_XSpanE);
-		particle.pos.y = RandomDouble(m_YSpanS, m_XSpanE);
-		particle.pos.z = RandomDouble(m_ZSpanS, m_XSpanE);
+	const std::vector<SolverRegistry::Entry>& entries = SolverRegistry::GetEntries();
+	const int entryCount = static_cast<int>(entries.size());
 
-		particle.vel.x = RandomDouble(xVel - 1.0, xVel + 1.0);
-		particle.vel.y = RandomDouble(yVel - 1.0, yVel + 1.0);
-		particle.vel.z = RandomDouble(zVel - 1.0, zVel + 1.0);
+	backend = std::clamp(backend, 0, entryCount - 1);
 
-		particle.density = 0.0;
-		particle.pressure = 0.0;
-		particle.viscosity = 0.0;
+	// Exclusive backends own state outside the solver, the old ones have to be gone first
+	m_CheckSolver.reset();
+	m_Solver.reset();
 
-		m_Particles.push_back(particle);
-	}
-}
+	m_Solver = entries[backend].factory();
 
-void Simulation::Update() {
+	// An exclusive backend can't run next to itself
+	if (crossCheck >= 0 && crossCheck < entryCount && !(crossCheck == backend && entries[backend].exclusive))
+		m_CheckSolver = entries[crossCheck].factory();
 
-	bool reset = false;
-	bool gravity = true;
-	bool collisions = true;
-	rnd::UIHelper::ReadSimulationData(reset, gravity, collisions, m_ParticleViscosity, m_ParticleRestDensity, m_ParticleDamping, m_ParticleStiffness);
-
-	if (reset) {
-		for (auto& elem : m_Particles) {
-			delete elem.entity;
-		}
-		m_Particles.clear();
-		Start();
-	}
+	if (m_CheckSolver)
+		m_CrossCheck.Init(*m_Solver, *m_CheckSolver, m_Params);
+	else
+		m_Solver->Init(m_Params);
 
-	// Apply collisions
-	for (size_t i = 0; i < m_Particles.size() && collisions; i++) {
-		Particle& current = m_Particles[i];
+	rnd::UIHelper::WriteCrossCheck(false, 0, 0.0, 0.0);
 
-		for (size_t j = 0; j < m_Particles.size(); j++) {
-			if (i == j)
-				continue;
+	m_PressureModels = 0;
+	for (int model = 0; model <= static_cast<int>(PressureModel::Pbf); model++) {
+		const PressureModel pressureModel = static_cast<PressureModel>(model);
 
-			Particle& neighbour = m_Particles[j];
+		if (m_Solver->Supports(pressureModel) && (!m_CheckSolver || m_CheckSolver->Supports(pressureModel)))
+			m_PressureModels |= 1u << model;
+	}
 
-			if (glm::length(current.pos - neighbour.pos) >= m_ParticleRadius)
-				continue;
+	rnd::UIHelper::WritePressureModels(m_PressureModels);
 
-			glm::dvec3 normal = glm::normalize(current.pos - neighbour.pos);
+	m_Timestep.Reset();
 
-			glm::dvec3 relVel = current.vel - neighbour.vel;
+	m_ParticleSystem.SetModel("models/lpsphere.obj", 0.2f);
+	ApplyToParticleSystem();
+}
 
-			double normalVel = glm::dot(relVel, normal);
+void Simulation::Update() {
 
-			if (normalVel > 0)
-				continue;
+	bool reset = false;
+	rnd::UIHelper::ReadSimulationData(reset, m_Params.gravity, m_Params.collisions, m_Params.viscosity, m_Params.restDensity, m_Params.damping, m_Params.stiffness);
 
-			current.vel += -normalVel * normal;
-			neighbour.vel -= -normalVel * normal;
-		}
-	}
+	int pressureModel;
+	rnd::UIHelper::ReadPressureSolver(pressureModel, m_Params.densityTolerance, m_Params.maxPressureIterations, m_Params.pbfIterations);
+	pressureModel = std::clamp(pressureModel, 0, static_cast<int>(PressureModel::Pbf));
+
+	if (reset)
+		Start();
+
+	// The UI tells the user about the fall back
+	m_Params.pressureModel = m_PressureModels & (1u << pressureModel) ? static_cast<PressureModel>(pressureModel) : PressureModel::Stiffness;
 
-	// Calculate density
-	for (size_t i = 0; i < m_Particles.size(); i++) {
-		Particle& current     = m_Particles[i];
-		double	  totalVolume = 0.0;
+	m_Solver->SetParams(m_Params);
+	if (m_CheckSolver)
+		m_CheckSolver->SetParams(m_Params);
 
-		for (size_t j = 0; j < m_Particles.size(); j++) {
-			if (i == j)
-				continue;
+	int stepRate, maxSubsteps;
+	rnd::UIHelper::ReadSimulationTimestep(stepRate, maxSubsteps);
+	m_Timestep.SetStepSize(1.0 / std::max(stepRate, 1));
+	m_Timestep.SetMaxSubsteps(static_cast<uint32_t>(std::max(maxSubsteps, 1)));
 
-			Particle& neighbor = m_Particles[j];
-			double distance = glm::distance(current.pos, neighbor.pos);
+	const uint32_t substeps = m_Timestep.Advance(static_cast<double>(rnd::Time::DeltaTime()));
+	for (uint32_t s = 0; s < substeps; s++) {
+		m_Solver->Step(m_Timestep.GetStepSize());
 
-			if (distance >= 2 * m_ParticleRadius)
-				continue;
+		if (m_CheckSolver)
+			m_CheckSolver->Step(m_Timestep.GetStepSize());
+	}
 
-			double h = (2 * m_ParticleRadius) - static_cast<double>(distance);
-			double overlapVolume = M_PI * (h * h * ((2.0 * m_ParticleRadius) - h) / 3.0);
-			totalVolume += overlapVolume;
-		}
+	rnd::UIHelper::WriteSimulationTimestep(static_cast<int>(substeps), static_cast<float>(m_Timestep.GetDroppedTime()));
 
-		double particleVolume = (4.0 / 3.0) * M_PI * (3 * m_ParticleRadius) + totalVolume;
+	const PressureSolveReport pressure = m_Solver->GetPressureReport();
+	rnd::UIHelper::WritePressureSolve(pressure.iterations, pressure.densityError);
 
-		current.density = 3 / particleVolume;
+	if (m_CheckSolver) {
+		const SolverDivergence& divergence = m_CrossCheck.Compare(*m_Solver, *m_CheckSolver);
+		rnd::UIHelper::WriteCrossCheck(divergence.valid, divergence.step, divergence.maxError, divergence.rmsError);
 	}
 
-	for (size_t i = 0; i < m_Particles.size(); i++) {
-		Particle& current = m_Particles[i];
+	if (substeps > 0)
+		ApplyToParticleSystem();
+}
 
-		glm::dvec3 pressureForce{ 0.0 };
+void Simulation::ApplyToParticleSystem() {
+	// Drawn by the renderer straight from the backend's buffers
+	if (m_Solver->DrawsParticles()) {
+		m_ParticleSystem.Clear();
+		return;
+	}
 
-		for (size_t j = 0; j < m_Particles.size(); j++) {
-			if (i == j)
-				continue;
-			Particle& neighbor = m_Particles[j];
+	const SolverView particles = m_Solver->Positions();
 
+	m_Positions.resize(particles.Size());
+	m_Colors.resize(particles.Size());
 
-			const glm::dvec3 velocityDiff = neighbor.vel - current.vel;
-			const double distance = glm::distance(current.pos, neighbor.pos);
+	for (size_t i = 0; i < particles.Size(); i++) {
+		const glm::dvec3 vel = particles.Vel(i);
 
-			if (distance >= m_ParticleRadius * 2.0)
-				continue;
-			
-			const glm::dvec3 force = m_ParticleViscosity * rnd::Time::SimulationDeltaTime() * m_ParticleDamping * velocityDiff / (distance * distance);
-			current.vel += force;
-			neighbor.vel -= force;
+		m_Positions[i] = glm::vec3{ particles.Pos(i) };
+		glm::vec4 nonColor{ fabs((vel.x + vel.y + vel.z) / 3 + 0.5), fabs(4 * particles.density[i]), fabs(0.5f), 1.0f };
+		m_Colors[i] = glm::normalize(nonColor);
+	}
 
+	m_ParticleSystem.SetParticles(m_Positions, m_Colors);
+}
 
-			glm::dvec3 direction = neighbor.pos - current.pos;
-			const double densityDiff = current.density + neighbor.density - 2.0 * m_ParticleRestDensity;
-			const double pressure = m_ParticleStiffness * densityDiff;
+void Simulation::ListBackends() {
+	if (m_bBackendsListed)
+		return;
 
-			pressureForce += pressure * rnd::Time::SimulationDeltaTime() * m_ParticleDamping * (direction / (distance * distance));
-		}
+	std::vector<std::string> names;
+	std::vector<int> maxParticles;
 
-		current.vel += pressureForce;
+	for (const SolverRegistry::Entry& entry : SolverRegistry::GetEntries()) {
+		names.push_back(entry.name);
+		maxParticles.push_back(entry.maxParticles);
 	}
 
-	// Position Update
-	for (size_t i = 0; i < m_Particles.size(); i++) {
-		Particle& particle = m_Particles[i];
-
-		if (gravity)
-			particle.vel.z -= m_Gravity * rnd::Time::SimulationDeltaTime();
-
-		particle.pos += particle.vel * static_cast<double>(rnd::Time::SimulationDeltaTime());
-
-		if (particle.pos.x <= 0) {
-			particle.pos.x = 0;
-			particle.vel.x = -particle.vel.x;
-			particle.vel *= m_ParticleDamping;
-		}
-
-		if (particle.pos.y <= 0) {
-			particle.pos.y = 0;
-			particle.vel.y = -particle.vel.y;
-			particle.vel *= m_ParticleDamping;
-		}
-
-		double rnd = 0;// RandomDouble(0.0, 0.1);
-		if (particle.pos.z <= 0 + rnd) {
-			particle.pos.z = 0 + rnd;
-			particle.vel.z = -particle.vel.z;
-			particle.vel *= m_ParticleDamping;
-		}
-
-		if (particle.pos.x >= m_SimulationWidth) {
-			particle.pos.x = m_SimulationWidth;
-			particle.vel.x = -particle.vel.x;
-			particle.vel *= m_ParticleDamping;
-		}
-
-		if (particle.pos.y >= m_SimulationDepth) {
-			particle.pos.y = m_SimulationDepth;
-			particle.vel.y = -particle.vel.y;
-			particle.vel *= m_ParticleDamping;
-		}
-
-		if (particle.pos.z >= m_SimulationHeight) {
-			particle.pos.z = m_SimulationHeight;
-			particle.vel.z = -particle.vel.z;
-			particle.vel *= m_ParticleDamping;
-		}
-
-		particle.Apply();
-	}
-}
\ No newline at end of file
+	// Entries are sorted by priority, the first one is the default
+	rnd::UIHelper::WriteSolverBackends(names, maxParticles, 0);
+	m_bBackendsListed = true;
+}
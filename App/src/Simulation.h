@@ -1,52 +1,24 @@
 #pragma once
 
 #include <Rnd/OScript.h>
-#include <Rnd/Entity.h>
+#include <Rnd/ParticleSystem.h>
 
-#include <array>
-#include <chrono>
-#include <random>
-#include <set>
-#include <random>
+#include <FixedTimestep.h>
 
-#define _USE_MATH_DEFINES
-#include <math.h>
+#include "Solver.h"
+#include "SolverCrossCheck.h"
 
-#include <glm/glm.hpp>
-
-class Particle {
-public:
-	Particle() {
-		entity = new rnd::Entity();
-		rnd::Transform particleTransform;
-		particleTransform.scale = glm::vec3{ 0.2f };
-		particleTransform.translate = pos;
-		entity->SetModel("models/lpsphere.obj", glm::vec4{ 0.5f, 0.6f, 1.0f, 1.0f });
-		entity->SetTransform(particleTransform);
-	}
-
-	~Particle() { }
-
-	void Apply() {
-		rnd::Transform particleTransform = entity->GetTransfrom();
-		particleTransform.translate = pos;
-		entity->SetTransform(particleTransform);
-		glm::vec4 nonColor{ fabs((vel.x + vel.y + vel.z) / 3 + 0.5), fabs(4 * density), fabs(0.5f), 1.0f };
-		entity->SetColor(glm::normalize(nonColor));
-	}
-
-	rnd::Entity* entity;
-
-	glm::dvec3 pos{ 0.0 };
-	glm::dvec3 vel{ 0.0 };
+#include <memory>
+#include <vector>
 
-	double density = 0.0;
-	double pressure = 0.0;
-	double viscosity = 0.0;
-
-
-};
+#include <glm/glm.hpp>
 
+//
+// Script that runs a solver backend inside the renderer.
+// Reads the parameters from the UI and draws the particles through a ParticleSystem,
+// unless the backend draws them itself. The backend advances in fixed steps, as many per
+// frame as the real frame time asks for. A second backend can run along to cross-check it.
+//
 class Simulation : rnd::OScript {
 private:
 
@@ -56,33 +28,27 @@ private:
 	// Runs on every frame
 	void Update();
 
-	int m_NumberOfParticles = 1000;
+	// Pushes particle positions and colors to the particle system in one batch
+	void ApplyToParticleSystem();
+
+	// Lists the registered backends in the UI, once
+	void ListBackends();
 
+	SimulationParams m_Params;
+	eng::FixedTimestep m_Timestep;
 
-	// Constants - Particles
-	const double m_ParticleRadius = 1.0;
-	//const double m_ParticleMass = 18.0;
-	//const double m_ParticleGasConstant = 461.5;
-	double m_ParticleRestDensity = 5.0;
-	double m_ParticleViscosity = 0.1;
-	double m_ParticleStiffness = 3;
-	double m_ParticleDamping = 0.98;
+	// Backend picked in the UI and the one checked against it, both replaced on Reset
+	std::unique_ptr<Solver> m_Solver;
+	std::unique_ptr<Solver> m_CheckSolver;
+	SolverCrossCheck m_CrossCheck;
+	bool m_bBackendsListed = false;
 
-	// Constants - Simulation
-	const double m_SimulationWidth = 20.0;
-	const double m_SimulationHeight = 20.0;
-	const double m_SimulationDepth = 20.0;
-	const double m_Gravity = 9.8;
-	const double m_MaxSpeed = 350.0;
+	// Bit n is set when both backends run PressureModel n, the others fall back to the stiffness model
+	uint32_t m_PressureModels = 1;
 
-	// Constants - Spawn
-	const double m_XSpanS = 2;
-	const double m_XSpanE = 18;
-	const double m_YSpanS = 2;
-	const double m_YSpanE = 18;
-	const double m_ZSpanS = 10;
-	const double m_ZSpanE = 18;
+	rnd::ParticleSystem m_ParticleSystem;
 
-	// Particle Vector
-	std::vector<Particle> m_Particles;
-};
\ No newline at end of file
+	// Staging for the particle system, reused every frame
+	std::vector<glm::vec3> m_Positions;
+	std::vector<glm::vec4> m_Colors;
+};
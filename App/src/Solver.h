@@ -0,0 +1,62 @@
+#pragma once
+
+#include "FluidSolver.h"
+
+#include <cstdint>
+#include <span>
+
+#include <glm/glm.hpp>
+
+// Read-only view of the particles of a backend, valid until the next call on it
+struct SolverView {
+	std::span<const double> posX, posY, posZ;
+	std::span<const double> velX, velY, velZ;
+	std::span<const double> density;
+
+	// Index of every particle id, empty when the streams are in id order
+	std::span<const uint32_t> slot;
+
+	// Steps the backend had taken when the particles were captured
+	uint64_t step = 0;
+
+	inline size_t Size() const { return posX.size(); }
+	inline size_t IndexOf(uint32_t particleId) const { return slot.empty() ? particleId : slot[particleId]; }
+
+	inline glm::dvec3 Pos(size_t i) const { return glm::dvec3{ posX[i], posY[i], posZ[i] }; }
+	inline glm::dvec3 Vel(size_t i) const { return glm::dvec3{ velX[i], velY[i], velZ[i] }; }
+};
+
+//
+// Particle solver backend. Backends are created through the SolverRegistry,
+// the caller owns the timestep and hands every fixed step to Step.
+//
+class Solver {
+public:
+	virtual ~Solver() = default;
+
+	// Spawns the particles of FluidSolver::Start, replaces the current ones
+	virtual void Init(const SimulationParams& params) = 0;
+
+	// Picked up by the next step
+	virtual void SetParams(const SimulationParams& params) = 0;
+
+	virtual void Step(double dt) = 0;
+
+	// Backends that keep their particles on another device may return an older state, see SolverView::step
+	virtual SolverView Positions() = 0;
+
+	// Steps taken so far, including the ones Positions doesn't show yet
+	virtual uint64_t GetStepCount() const = 0;
+
+	// Pressure solve of the last step, empty for backends that only have the stiffness model
+	virtual PressureSolveReport GetPressureReport() const { return PressureSolveReport{}; }
+
+	// Pressure models the backend runs, it steps any other one with the stiffness model
+	virtual bool Supports(PressureModel model) const { return model == PressureModel::Stiffness; }
+
+	// Backends that draw their particles themselves only copy them back while this is set
+	virtual void RequirePositions(bool) {}
+	virtual bool DrawsParticles() const { return false; }
+
+	virtual const char* GetName() const = 0;
+};
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include "SolverCrossCheck.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+void SolverCrossCheck::Init(Solver& reference, Solver& candidate, const SimulationParams& params) {
+	// The spawn comes from rand(), both backends draw the same sequence. The seed comes from an engine
+	// of its own, reseeding rand() from itself would replay the spawn of the last Init.
+	std::mt19937 seedEngine{ std::random_device{}() };
+	const unsigned seed = static_cast<unsigned>(seedEngine());
+
+	std::srand(seed);
+	reference.Init(params);
+
+	std::srand(seed);
+	candidate.Init(params);
+
+	reference.RequirePositions(true);
+	candidate.RequirePositions(true);
+
+	m_Reference.clear();
+	m_Candidate.clear();
+	m_Divergence = SolverDivergence{};
+}
+
+const SolverDivergence& SolverCrossCheck::Compare(Solver& reference, Solver& candidate) {
+	Capture(reference, m_Reference);
+	Capture(candidate, m_Candidate);
+
+	// Latest step both sides have, older snapshots can't be compared any more
+	for (auto ref = m_Reference.rbegin(); ref != m_Reference.rend(); ref++) {
+		auto match = std::find_if(m_Candidate.begin(), m_Candidate.end(), [&](const Snapshot& snapshot) { return snapshot.step == ref->step; });
+
+		if (match == m_Candidate.end())
+			continue;
+
+		const size_t count = std::min(ref->positions.size(), match->positions.size());
+
+		double maxSq = 0.0;
+		double sumSq = 0.0;
+
+		for (size_t id = 0; id < count; id++) {
+			const glm::dvec3 delta = ref->positions[id] - match->positions[id];
+			const double distSq = glm::dot(delta, delta);
+
+			maxSq = std::max(maxSq, distSq);
+			sumSq += distSq;
+		}
+
+		m_Divergence.valid = true;
+		m_Divergence.step = ref->step;
+		m_Divergence.maxError = std::sqrt(maxSq);
+		m_Divergence.rmsError = count ? std::sqrt(sumSq / count) : 0.0;
+
+		const uint64_t step = ref->step;
+		auto older = [step](const Snapshot& snapshot) { return snapshot.step < step; };
+
+		m_Reference.erase(std::remove_if(m_Reference.begin(), m_Reference.end(), older), m_Reference.end());
+		m_Candidate.erase(std::remove_if(m_Candidate.begin(), m_Candidate.end(), older), m_Candidate.end());
+		break;
+	}
+
+	return m_Divergence;
+}
+
+void SolverCrossCheck::Capture(Solver& solver, std::deque<Snapshot>& snapshots) {
+	const SolverView view = solver.Positions();
+
+	if (!snapshots.empty() && snapshots.back().step == view.step)
+		return;
+
+	Snapshot snapshot;
+	snapshot.step = view.step;
+	snapshot.positions.resize(view.Size());
+
+	for (uint32_t id = 0; id < view.Size(); id++)
+		snapshot.positions[id] = view.Pos(view.IndexOf(id));
+
+	snapshots.push_back(std::move(snapshot));
+
+	if (snapshots.size() > s_MaxSnapshots)
+		snapshots.pop_front();
+}
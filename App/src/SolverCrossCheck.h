@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Solver.h"
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Distance between the positions of the same particle in two backends after the same step
+struct SolverDivergence {
+	// False until both backends showed positions of a common step
+	bool valid = false;
+	uint64_t step = 0;
+
+	double maxError = 0.0;
+	double rmsError = 0.0;
+};
+
+//
+// Runs a candidate backend next to a reference one from the same spawn and reports how far apart
+// their particles drift. Backends that show older positions than they stepped (see SolverView::step)
+// are compared at the latest step both of them showed.
+//
+class SolverCrossCheck {
+public:
+	// Starts both backends from the same rand() draws
+	void Init(Solver& reference, Solver& candidate, const SimulationParams& params);
+
+	// Captures the positions both backends show now, compares them once they share a step
+	const SolverDivergence& Compare(Solver& reference, Solver& candidate);
+
+	inline const SolverDivergence& GetDivergence() const { return m_Divergence; }
+
+private:
+	struct Snapshot {
+		uint64_t step = 0;
+
+		// In particle id order
+		std::vector<glm::dvec3> positions;
+	};
+
+	static void Capture(Solver& solver, std::deque<Snapshot>& snapshots);
+
+	std::deque<Snapshot> m_Reference;
+	std::deque<Snapshot> m_Candidate;
+
+	SolverDivergence m_Divergence;
+
+	// Snapshots kept per backend, covers the frames a GPU copy trails its steps
+	static constexpr size_t s_MaxSnapshots = 8;
+};
\ No newline at end of file
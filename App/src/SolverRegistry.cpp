@@ -0,0 +1,46 @@
+#include "SolverRegistry.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+// Function local, registrars of other translation units may run before any global of this one
+std::vector<SolverRegistry::Entry>& SolverRegistry::Entries() {
+	static std::vector<Entry> entries;
+	return entries;
+}
+
+void SolverRegistry::Register(Entry entry) {
+	std::vector<Entry>& entries = Entries();
+
+	if (Find(entry.name))
+		throw std::runtime_error("Solver backend " + entry.name + " registered twice!");
+
+	entries.push_back(std::move(entry));
+
+	// Stable, backends of equal priority keep their registration order
+	std::stable_sort(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) { return lhs.priority > rhs.priority; });
+}
+
+std::unique_ptr<Solver> SolverRegistry::Create(const std::string& name) {
+	const Entry* entry = Find(name);
+	return entry ? entry->factory() : nullptr;
+}
+
+const SolverRegistry::Entry* SolverRegistry::Find(const std::string& name) {
+	for (const Entry& entry : Entries())
+		if (entry.name == name)
+			return &entry;
+
+	return nullptr;
+}
+
+const std::vector<SolverRegistry::Entry>& SolverRegistry::GetEntries() {
+	return Entries();
+}
+
+const std::string& SolverRegistry::Default() {
+	if (Entries().empty())
+		throw std::runtime_error("No solver backend registered!");
+
+	return Entries().front().name;
+}
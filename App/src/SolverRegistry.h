@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Solver.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+//
+// Solver backends compiled into the executable. Every backend registers itself from its own
+// translation unit, so builds without the renderer simply don't list the Vulkan one.
+//
+class SolverRegistry {
+public:
+	using Factory = std::function<std::unique_ptr<Solver>()>;
+
+	struct Entry {
+		std::string name;
+
+		// Picked by Default, the highest one wins
+		int priority = 0;
+
+		// Particle count the backend keeps interactive
+		int maxParticles = 0;
+
+		// Only one instance may exist at a time, it owns state outside the solver
+		bool exclusive = false;
+
+		Factory factory;
+	};
+
+	// Registers a backend while static objects are constructed
+	struct Registrar {
+		Registrar(Entry entry) { Register(std::move(entry)); }
+	};
+
+	static void Register(Entry entry);
+
+	// nullptr for unknown names
+	static std::unique_ptr<Solver> Create(const std::string& name);
+
+	static const Entry* Find(const std::string& name);
+
+	// Sorted by priority, the default first
+	static const std::vector<Entry>& GetEntries();
+
+	// Name of the backend with the highest priority
+	static const std::string& Default();
+
+private:
+	static std::vector<Entry>& Entries();
+};
\ No newline at end of file
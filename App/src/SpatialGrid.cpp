@@ -0,0 +1,72 @@
+#include "SpatialGrid.h"
+
+#include <cmath>
+
+void SpatialGrid::Resize(const glm::dvec3& boxMin, const glm::dvec3& boxMax, double cellSize) {
+	m_Origin = boxMin;
+	m_BoxMax = boxMax;
+	m_CellSize = cellSize;
+	m_InvCellSize = 1.0 / cellSize;
+
+	const glm::dvec3 extent = boxMax - boxMin;
+	m_Dims.x = std::max(1, static_cast<int>(std::ceil(extent.x * m_InvCellSize)));
+	m_Dims.y = std::max(1, static_cast<int>(std::ceil(extent.y * m_InvCellSize)));
+	m_Dims.z = std::max(1, static_cast<int>(std::ceil(extent.z * m_InvCellSize)));
+
+	m_CellStart.assign(static_cast<size_t>(m_Dims.x) * m_Dims.y * m_Dims.z + 1, 0u);
+
+	for (auto& blocks : m_ColourBlocks)
+		blocks.clear();
+
+	for (int z = 0; z < m_Dims.z; z++)
+		for (int y = 0; y < m_Dims.y; y++)
+			for (int x = 0; x < m_Dims.x; x++)
+				m_ColourBlocks[(x & 1) | ((y & 1) << 1) | ((z & 1) << 2)].push_back(glm::ivec3{ x, y, z });
+}
+
+void SpatialGrid::SetCellSize(double cellSize) {
+	if (cellSize != m_CellSize)
+		Resize(m_Origin, m_BoxMax, cellSize);
+}
+
+size_t SpatialGrid::MemoryFootprint() const {
+	size_t bytes = (m_CellStart.capacity() + m_CellFill.capacity() + m_CellEntries.capacity() + m_ParticleCells.capacity()) * sizeof(uint32_t);
+
+	for (const auto& blocks : m_ColourBlocks)
+		bytes += blocks.capacity() * sizeof(glm::ivec3);
+
+	return bytes;
+}
+
+glm::ivec3 SpatialGrid::CellCoord(const glm::dvec3& pos) const {
+	// Particles sitting exactly on (or pushed past) the walls go into the border cells
+	glm::ivec3 coord{
+		  static_cast<int>(std::floor((pos.x - m_Origin.x) * m_InvCellSize))
+		, static_cast<int>(std::floor((pos.y - m_Origin.y) * m_InvCellSize))
+		, static_cast<int>(std::floor((pos.z - m_Origin.z) * m_InvCellSize))
+	};
+
+	coord.x = std::clamp(coord.x, 0, m_Dims.x - 1);
+	coord.y = std::clamp(coord.y, 0, m_Dims.y - 1);
+	coord.z = std::clamp(coord.z, 0, m_Dims.z - 1);
+
+	return coord;
+}
+
+uint32_t SpatialGrid::MortonCode(const glm::dvec3& pos) const {
+	// Spreads the low 10 bits of v so there are two zero bits between each of them
+	auto spread = [](uint32_t v) {
+		v &= 0x000003ffu;
+		v = (v ^ (v << 16)) & 0xff0000ffu;
+		v = (v ^ (v << 8)) & 0x0300f00fu;
+		v = (v ^ (v << 4)) & 0x030c30c3u;
+		v = (v ^ (v << 2)) & 0x09249249u;
+		return v;
+	};
+
+	const glm::ivec3 coord = CellCoord(pos);
+
+	return spread(static_cast<uint32_t>(coord.x))
+		| (spread(static_cast<uint32_t>(coord.y)) << 1)
+		| (spread(static_cast<uint32_t>(coord.z)) << 2);
+}
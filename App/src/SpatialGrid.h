@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+//
+// Uniform grid used for the neighbour search of the simulation.
+// Particles are bucketed with a counting sort every step, so a lookup
+// only has to visit the 27 cells around a position instead of every particle.
+//
+class SpatialGrid {
+public:
+	// Fits the grid over the [boxMin, boxMax] volume with cubic cells of the given size
+	void Resize(const glm::dvec3& boxMin, const glm::dvec3& boxMax, double cellSize);
+
+	// Refits the grid over the volume of the last Resize, the buckets are empty until the next Build
+	void SetCellSize(double cellSize);
+
+	// Rebuilds the cell buckets, position(i) must return the glm::dvec3 of particle i
+	template<typename PositionFunc>
+	void Build(size_t count, PositionFunc&& position) {
+		m_ParticleCells.resize(count);
+		m_CellEntries.resize(count);
+		std::fill(m_CellStart.begin(), m_CellStart.end(), 0u);
+
+		for (size_t i = 0; i < count; i++) {
+			const uint32_t cell = CellIndex(CellCoord(position(i)));
+			m_ParticleCells[i] = cell;
+			m_CellStart[cell + 1]++;
+		}
+
+		for (size_t c = 1; c < m_CellStart.size(); c++)
+			m_CellStart[c] += m_CellStart[c - 1];
+
+		m_CellFill.assign(m_CellStart.begin(), m_CellStart.end() - 1);
+		for (size_t i = 0; i < count; i++)
+			m_CellEntries[m_CellFill[m_ParticleCells[i]]++] = static_cast<uint32_t>(i);
+	}
+
+	// Calls func(j) for every particle j in the 27 cells surrounding pos
+	template<typename Func>
+	void ForEachNeighbour(const glm::dvec3& pos, Func&& func) const {
+		const glm::ivec3 center = CellCoord(pos);
+
+		const int xs = std::max(center.x - 1, 0), xe = std::min(center.x + 1, m_Dims.x - 1);
+		const int ys = std::max(center.y - 1, 0), ye = std::min(center.y + 1, m_Dims.y - 1);
+		const int zs = std::max(center.z - 1, 0), ze = std::min(center.z + 1, m_Dims.z - 1);
+
+		for (int z = zs; z <= ze; z++)
+			for (int y = ys; y <= ye; y++)
+				for (int x = xs; x <= xe; x++) {
+					const uint32_t cell = CellIndex(glm::ivec3{ x, y, z });
+
+					for (uint32_t e = m_CellStart[cell]; e < m_CellStart[cell + 1]; e++)
+						func(static_cast<size_t>(m_CellEntries[e]));
+				}
+	}
+
+	// Calls func(i, j) once for every unordered pair of particles owned by the block at base.
+	// A block is the 2x2x2 group of cells starting at base, it owns the cell pairs whose
+	// component-wise minimum cell is base. No distance check is done here.
+	template<typename Func>
+	void ForEachPairInBlock(const glm::ivec3& base, Func&& func) const {
+		for (const auto& cellPair : s_BlockCellPairs) {
+			const glm::ivec3 a = base + Corner(cellPair[0]);
+			const glm::ivec3 b = base + Corner(cellPair[1]);
+
+			if (b.x >= m_Dims.x || b.y >= m_Dims.y || b.z >= m_Dims.z || a.x >= m_Dims.x || a.y >= m_Dims.y || a.z >= m_Dims.z)
+				continue;
+
+			const uint32_t cellA = CellIndex(a);
+			const uint32_t cellB = CellIndex(b);
+
+			// Pairs inside the base cell
+			if (cellA == cellB) {
+				for (uint32_t e1 = m_CellStart[cellA]; e1 < m_CellStart[cellA + 1]; e1++)
+					for (uint32_t e2 = e1 + 1; e2 < m_CellStart[cellA + 1]; e2++)
+						func(static_cast<size_t>(m_CellEntries[e1]), static_cast<size_t>(m_CellEntries[e2]));
+
+				continue;
+			}
+
+			for (uint32_t e1 = m_CellStart[cellA]; e1 < m_CellStart[cellA + 1]; e1++)
+				for (uint32_t e2 = m_CellStart[cellB]; e2 < m_CellStart[cellB + 1]; e2++)
+					func(static_cast<size_t>(m_CellEntries[e1]), static_cast<size_t>(m_CellEntries[e2]));
+		}
+	}
+
+	// Block bases of one colour. Blocks of the same colour are at least 2 cells apart on some
+	// axis, so their pairs never share a particle and the blocks can be processed in parallel.
+	inline const std::vector<glm::ivec3>& GetColourBlocks(int colour) const { return m_ColourBlocks[colour]; }
+
+	// Z-order (Morton) key of the cell holding pos, 10 bits per axis
+	uint32_t MortonCode(const glm::dvec3& pos) const;
+
+	inline const glm::ivec3& GetDims() const { return m_Dims; }
+	inline double GetCellSize() const { return m_CellSize; }
+
+	// Bytes held by the buckets and the block lists
+	size_t MemoryFootprint() const;
+
+	static constexpr int s_ColourCount = 8;
+
+private:
+	glm::ivec3 CellCoord(const glm::dvec3& pos) const;
+
+	// Corner of the 2x2x2 block, bit 0 is x, bit 1 is y, bit 2 is z
+	static inline glm::ivec3 Corner(int bits) {
+		return glm::ivec3{ bits & 1, (bits >> 1) & 1, (bits >> 2) & 1 };
+	}
+
+	// The base cell with itself plus the 13 half-shell directions. Corners never share an
+	// axis bit, so the block base is the component-wise minimum of both cells.
+	static constexpr int s_BlockCellPairs[14][2] = {
+		  { 0, 0 }
+		, { 0, 1 }, { 0, 2 }, { 0, 3 }, { 0, 4 }, { 0, 5 }, { 0, 6 }, { 0, 7 }
+		, { 1, 2 }, { 1, 4 }, { 2, 4 }, { 1, 6 }, { 2, 5 }, { 3, 4 }
+	};
+
+	inline uint32_t CellIndex(const glm::ivec3& coord) const {
+		return static_cast<uint32_t>((coord.z * m_Dims.y + coord.y) * m_Dims.x + coord.x);
+	}
+
+	glm::dvec3 m_Origin{ 0.0 };
+	glm::dvec3 m_BoxMax{ 1.0 };
+	glm::ivec3 m_Dims{ 1 };
+	double m_CellSize = 1.0;
+	double m_InvCellSize = 1.0;
+
+	// Prefix sums of the cell counts, entries of cell c are in [m_CellStart[c], m_CellStart[c + 1])
+	std::vector<uint32_t> m_CellStart;
+	std::vector<uint32_t> m_CellFill;
+	std::vector<uint32_t> m_CellEntries;
+	std::vector<uint32_t> m_ParticleCells;
+
+	std::vector<glm::ivec3> m_ColourBlocks[s_ColourCount];
+};
@@ -0,0 +1,218 @@
+#pragma once
+
+#include "PairKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <immintrin.h>
+
+#include <glm/glm.hpp>
+
+//
+// SPH smoothing kernels with the support as a template parameter, every coefficient is a
+// compile time constant. Each kernel has scalar, AVX2 and AVX-512 overloads of the same
+// expressions, so the pair loops are instantiated per kernel and per ISA without branches.
+// Everything is zero from the support on, gradients stay finite when particles coincide.
+// Value takes the distance and its square, every kernel reads the one it needs.
+//
+
+namespace KernelMath {
+	constexpr double Pow(double base, int exponent) {
+		return exponent == 0 ? 1.0 : base * Pow(base, exponent - 1);
+	}
+
+	constexpr double s_Pi = 3.14159265358979323846;
+
+	// Distances are clamped to this fraction of the support before they divide anything
+	constexpr double s_MinDistanceRatio = 1e-6;
+}
+
+// Müller et al. 2003, for densities. Smooth at the centre, so its own gradient is too weak for pressure.
+template<double Support>
+struct Poly6Kernel {
+	static constexpr double s_Support = Support;
+	static constexpr double s_SupportSq = Support * Support;
+	static constexpr double s_Coef = 315.0 / (64.0 * KernelMath::s_Pi * KernelMath::Pow(Support, 9));
+
+	static inline double Value(double, double distanceSq) {
+		const double x = std::max(s_SupportSq - distanceSq, 0.0);
+		return s_Coef * (x * x * x);
+	}
+
+	FS_SIMD_TARGET("avx2")
+	static inline __m256d Value(__m256d, __m256d distanceSq) {
+		const __m256d x = _mm256_max_pd(_mm256_sub_pd(_mm256_set1_pd(s_SupportSq), distanceSq), _mm256_setzero_pd());
+		return _mm256_mul_pd(_mm256_set1_pd(s_Coef), _mm256_mul_pd(_mm256_mul_pd(x, x), x));
+	}
+
+	FS_SIMD_TARGET("avx512f")
+	static inline __m512d Value(__m512d, __m512d distanceSq) {
+		const __m512d x = _mm512_max_pd(_mm512_sub_pd(_mm512_set1_pd(s_SupportSq), distanceSq), _mm512_setzero_pd());
+		return _mm512_mul_pd(_mm512_set1_pd(s_Coef), _mm512_mul_pd(_mm512_mul_pd(x, x), x));
+	}
+};
+
+// Müller et al. 2003, for pressure. The gradient keeps its full strength down to zero distance.
+template<double Support>
+struct SpikyKernel {
+	static constexpr double s_Support = Support;
+	static constexpr double s_Coef = 15.0 / (KernelMath::s_Pi * KernelMath::Pow(Support, 6));
+	static constexpr double s_GradientCoef = -45.0 / (KernelMath::s_Pi * KernelMath::Pow(Support, 6));
+	static constexpr double s_MinDistance = KernelMath::s_MinDistanceRatio * Support;
+
+	static inline double Value(double distance, double) {
+		const double x = std::max(s_Support - distance, 0.0);
+		return s_Coef * (x * x * x);
+	}
+
+	// The gradient at the first particle of a pair is (first - second) times this
+	static inline double GradientScale(double distance) {
+		const double x = std::max(s_Support - distance, 0.0);
+		return s_GradientCoef * (x * x) / std::max(distance, s_MinDistance);
+	}
+
+	FS_SIMD_TARGET("avx2")
+	static inline __m256d Value(__m256d distance, __m256d) {
+		const __m256d x = _mm256_max_pd(_mm256_sub_pd(_mm256_set1_pd(s_Support), distance), _mm256_setzero_pd());
+		return _mm256_mul_pd(_mm256_set1_pd(s_Coef), _mm256_mul_pd(_mm256_mul_pd(x, x), x));
+	}
+
+	FS_SIMD_TARGET("avx2")
+	static inline __m256d GradientScale(__m256d distance) {
+		const __m256d x = _mm256_max_pd(_mm256_sub_pd(_mm256_set1_pd(s_Support), distance), _mm256_setzero_pd());
+		return _mm256_div_pd(_mm256_mul_pd(_mm256_set1_pd(s_GradientCoef), _mm256_mul_pd(x, x)), _mm256_max_pd(distance, _mm256_set1_pd(s_MinDistance)));
+	}
+
+	FS_SIMD_TARGET("avx512f")
+	static inline __m512d Value(__m512d distance, __m512d) {
+		const __m512d x = _mm512_max_pd(_mm512_sub_pd(_mm512_set1_pd(s_Support), distance), _mm512_setzero_pd());
+		return _mm512_mul_pd(_mm512_set1_pd(s_Coef), _mm512_mul_pd(_mm512_mul_pd(x, x), x));
+	}
+
+	FS_SIMD_TARGET("avx512f")
+	static inline __m512d GradientScale(__m512d distance) {
+		const __m512d x = _mm512_max_pd(_mm512_sub_pd(_mm512_set1_pd(s_Support), distance), _mm512_setzero_pd());
+		return _mm512_div_pd(_mm512_mul_pd(_mm512_set1_pd(s_GradientCoef), _mm512_mul_pd(x, x)), _mm512_max_pd(distance, _mm512_set1_pd(s_MinDistance)));
+	}
+};
+
+// Müller et al. 2003, for viscosity. Only the Laplacian is used, it's positive everywhere inside the support.
+template<double Support>
+struct ViscosityKernel {
+	static constexpr double s_Support = Support;
+	static constexpr double s_LaplacianCoef = 45.0 / (KernelMath::s_Pi * KernelMath::Pow(Support, 6));
+
+	static inline double Laplacian(double distance) {
+		return s_LaplacianCoef * std::max(s_Support - distance, 0.0);
+	}
+
+	FS_SIMD_TARGET("avx2")
+	static inline __m256d Laplacian(__m256d distance) {
+		return _mm256_mul_pd(_mm256_set1_pd(s_LaplacianCoef), _mm256_max_pd(_mm256_sub_pd(_mm256_set1_pd(s_Support), distance), _mm256_setzero_pd()));
+	}
+
+	FS_SIMD_TARGET("avx512f")
+	static inline __m512d Laplacian(__m512d distance) {
+		return _mm512_mul_pd(_mm512_set1_pd(s_LaplacianCoef), _mm512_max_pd(_mm512_sub_pd(_mm512_set1_pd(s_Support), distance), _mm512_setzero_pd()));
+	}
+};
+
+// Wendland C2 in 3D, for densities and pressure. The gradient needs no division.
+template<double Support>
+struct WendlandKernel {
+	static constexpr double s_Support = Support;
+	static constexpr double s_InvSupport = 1.0 / Support;
+	static constexpr double s_Coef = 21.0 / (2.0 * KernelMath::s_Pi * KernelMath::Pow(Support, 3));
+	static constexpr double s_GradientCoef = -210.0 / (KernelMath::s_Pi * KernelMath::Pow(Support, 5));
+
+	static inline double Value(double distance, double) {
+		const double q = std::min(distance * s_InvSupport, 1.0);
+		const double t = 1.0 - q;
+		const double tSq = t * t;
+		return s_Coef * (tSq * tSq) * (1.0 + 4.0 * q);
+	}
+
+	static inline double GradientScale(double distance) {
+		const double t = 1.0 - std::min(distance * s_InvSupport, 1.0);
+		return s_GradientCoef * (t * t * t);
+	}
+
+	FS_SIMD_TARGET("avx2")
+	static inline __m256d Value(__m256d distance, __m256d) {
+		const __m256d q = _mm256_min_pd(_mm256_mul_pd(distance, _mm256_set1_pd(s_InvSupport)), _mm256_set1_pd(1.0));
+		const __m256d t = _mm256_sub_pd(_mm256_set1_pd(1.0), q);
+		const __m256d tSq = _mm256_mul_pd(t, t);
+		const __m256d shape = _mm256_add_pd(_mm256_set1_pd(1.0), _mm256_mul_pd(_mm256_set1_pd(4.0), q));
+		return _mm256_mul_pd(_mm256_mul_pd(_mm256_set1_pd(s_Coef), _mm256_mul_pd(tSq, tSq)), shape);
+	}
+
+	FS_SIMD_TARGET("avx2")
+	static inline __m256d GradientScale(__m256d distance) {
+		const __m256d t = _mm256_sub_pd(_mm256_set1_pd(1.0), _mm256_min_pd(_mm256_mul_pd(distance, _mm256_set1_pd(s_InvSupport)), _mm256_set1_pd(1.0)));
+		return _mm256_mul_pd(_mm256_set1_pd(s_GradientCoef), _mm256_mul_pd(_mm256_mul_pd(t, t), t));
+	}
+
+	FS_SIMD_TARGET("avx512f")
+	static inline __m512d Value(__m512d distance, __m512d) {
+		const __m512d q = _mm512_min_pd(_mm512_mul_pd(distance, _mm512_set1_pd(s_InvSupport)), _mm512_set1_pd(1.0));
+		const __m512d t = _mm512_sub_pd(_mm512_set1_pd(1.0), q);
+		const __m512d tSq = _mm512_mul_pd(t, t);
+		const __m512d shape = _mm512_add_pd(_mm512_set1_pd(1.0), _mm512_mul_pd(_mm512_set1_pd(4.0), q));
+		return _mm512_mul_pd(_mm512_mul_pd(_mm512_set1_pd(s_Coef), _mm512_mul_pd(tSq, tSq)), shape);
+	}
+
+	FS_SIMD_TARGET("avx512f")
+	static inline __m512d GradientScale(__m512d distance) {
+		const __m512d t = _mm512_sub_pd(_mm512_set1_pd(1.0), _mm512_min_pd(_mm512_mul_pd(distance, _mm512_set1_pd(s_InvSupport)), _mm512_set1_pd(1.0)));
+		return _mm512_mul_pd(_mm512_set1_pd(s_GradientCoef), _mm512_mul_pd(_mm512_mul_pd(t, t), t));
+	}
+};
+
+// The kernels of one solver, picked at compile time
+template<typename DensityKernel, typename PressureKernel, typename ViscosityLaplacian>
+struct KernelSet {
+	using Density = DensityKernel;
+	using Pressure = PressureKernel;
+	using Viscosity = ViscosityLaplacian;
+
+	static constexpr double s_Support = Density::s_Support;
+
+	static_assert(Pressure::s_Support == s_Support && Viscosity::s_Support == s_Support, "Kernels of a set need the same support!");
+};
+
+// Pair interactions reach 2 * radius of the unit particles
+constexpr double s_KernelSupport = 2.0;
+
+using StandardKernels = KernelSet<Poly6Kernel<s_KernelSupport>, SpikyKernel<s_KernelSupport>, ViscosityKernel<s_KernelSupport>>;
+using WendlandKernels = KernelSet<WendlandKernel<s_KernelSupport>, WendlandKernel<s_KernelSupport>, ViscosityKernel<s_KernelSupport>>;
+
+// A particle with a full neighbourhood on a cubic lattice, the rest state of the solvers
+struct RestLattice {
+	// Density kernel summed over the particle and its neighbours
+	double weightSum = 0.0;
+
+	// Squared pressure gradients summed over the neighbours, the gradients themselves sum to zero by symmetry
+	double gradientSqSum = 0.0;
+};
+
+template<typename Kernels>
+inline RestLattice MakeRestLattice(double spacing) {
+	RestLattice lattice;
+	const int reach = static_cast<int>(std::ceil(Kernels::s_Support / spacing));
+
+	for (int x = -reach; x <= reach; x++)
+		for (int y = -reach; y <= reach; y++)
+			for (int z = -reach; z <= reach; z++) {
+				const glm::dvec3 offset = glm::dvec3{ static_cast<double>(x), static_cast<double>(y), static_cast<double>(z) } * spacing;
+				const double distanceSq = glm::dot(offset, offset);
+				const double distance = std::sqrt(distanceSq);
+
+				lattice.weightSum += Kernels::Density::Value(distance, distanceSq);
+
+				const double gradient = Kernels::Pressure::GradientScale(distance) * distance;
+				lattice.gradientSqSum += gradient * gradient;
+			}
+
+	return lattice;
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "VulkanSolver.h"
+
+#include "SolverRegistry.h"
+
+#include <Rnd/GpuSimulation.h>
+
+#include <algorithm>
+#include <memory>
+
+static SolverRegistry::Registrar s_VulkanBackend{ SolverRegistry::Entry{
+	"vulkan", 2, static_cast<int>(rnd::GpuSimulation::GetMaxParticles()), true,
+	[]() { return std::make_unique<VulkanSolver>(); }
+} };
+
+VulkanSolver::~VulkanSolver() {
+	rnd::GpuSimulation::SetReadback(false);
+	rnd::GpuSimulation::Stop();
+}
+
+void VulkanSolver::Init(const SimulationParams& params) {
+	// The box grows with the count like FluidSolver's, up to the largest one the GPU grid covers
+	SimulationParams spawnParams = params;
+	spawnParams.particleCount = std::min(params.particleCount, static_cast<int>(rnd::GpuSimulation::GetMaxParticles()));
+	spawnParams.boxScale = std::min(params.boxScale, static_cast<double>(Render::GpuSimulationState::s_MaxBoxScale));
+
+	// Same rand() draws as FluidSolver::Start, a CPU backend seeded alike starts from the same particles
+	ParticleStore spawn;
+	FluidSolver::Spawn(spawnParams, spawn);
+
+	std::vector<glm::vec3> positions(spawn.Size());
+	std::vector<glm::vec3> velocities(spawn.Size());
+
+	for (size_t i = 0; i < spawn.Size(); i++) {
+		positions[i] = glm::vec3{ spawn.Pos(i) };
+		velocities[i] = glm::vec3{ spawn.Vel(i) };
+	}
+
+	rnd::GpuSimulation::Start(positions, velocities);
+	SetParams(params);
+
+	m_Steps = 0;
+	m_ReadStep = 0;
+
+	m_ReadPositions = positions;
+	m_ReadVelocities = velocities;
+	m_ReadDensities.assign(positions.size(), 0.0f);
+}
+
+// The pressure model and its settings stay on the CPU, Supports only admits the stiffness model.
+// The shader runs the kernels of FluidSolver, its scales and mass are applied here.
+void VulkanSolver::SetParams(const SimulationParams& params) {
+	static const RestLattice s_RestLattice = MakeRestLattice<FluidSolver::Kernels>(s_ParticleRadius);
+
+	Render::GpuSimulationParams gpuParams;
+	gpuParams.restDensity = static_cast<float>(params.restDensity);
+	gpuParams.viscosity = static_cast<float>(params.viscosity * FluidSolver::s_ViscosityScale);
+	gpuParams.stiffness = static_cast<float>(params.stiffness * FluidSolver::s_StiffnessScale * params.restDensity);
+	gpuParams.mass = static_cast<float>(params.restDensity / s_RestLattice.weightSum);
+	gpuParams.damping = static_cast<float>(params.damping);
+	gpuParams.gravity = params.gravity ? static_cast<float>(FluidSolver::s_Gravity) : 0.0f;
+	gpuParams.collisions = params.collisions;
+	gpuParams.boxScale = static_cast<float>(std::min(params.boxScale, static_cast<double>(Render::GpuSimulationState::s_MaxBoxScale)));
+
+	rnd::GpuSimulation::SetParams(gpuParams);
+}
+
+void VulkanSolver::Step(double dt) {
+	rnd::GpuSimulation::Step(static_cast<float>(dt));
+	m_Steps++;
+}
+
+SolverView VulkanSolver::Positions() {
+	rnd::GpuSimulation::ReadParticles(m_ReadPositions, m_ReadVelocities, m_ReadDensities, m_ReadStep);
+
+	const size_t count = m_ReadPositions.size();
+
+	m_PosX.resize(count);
+	m_PosY.resize(count);
+	m_PosZ.resize(count);
+	m_VelX.resize(count);
+	m_VelY.resize(count);
+	m_VelZ.resize(count);
+	m_Density.resize(count);
+
+	for (size_t i = 0; i < count; i++) {
+		m_PosX[i] = m_ReadPositions[i].x;
+		m_PosY[i] = m_ReadPositions[i].y;
+		m_PosZ[i] = m_ReadPositions[i].z;
+		m_VelX[i] = m_ReadVelocities[i].x;
+		m_VelY[i] = m_ReadVelocities[i].y;
+		m_VelZ[i] = m_ReadVelocities[i].z;
+		m_Density[i] = m_ReadDensities[i];
+	}
+
+	// The GPU never reorders, streams are in particle order
+	SolverView view;
+	view.posX = m_PosX;
+	view.posY = m_PosY;
+	view.posZ = m_PosZ;
+	view.velX = m_VelX;
+	view.velY = m_VelY;
+	view.velZ = m_VelZ;
+	view.density = m_Density;
+	view.step = m_ReadStep;
+
+	return view;
+}
+
+void VulkanSolver::RequirePositions(bool required) {
+	rnd::GpuSimulation::SetReadback(required);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Solver.h"
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+//
+// Runs the steps in the renderer's compute passes (rnd::GpuSimulation), the renderer draws
+// the particles straight from its buffers. Positions are copied back only while required
+// and arrive a few frames after their steps. params.boxScale grows the box up to GpuSimulationState::s_MaxBoxScale.
+// Only the stiffness model runs on the GPU, Solver::Supports turns the others down.
+//
+class VulkanSolver : public Solver {
+public:
+	~VulkanSolver() override;
+
+	void Init(const SimulationParams& params) override;
+	void SetParams(const SimulationParams& params) override;
+	void Step(double dt) override;
+
+	SolverView Positions() override;
+	inline uint64_t GetStepCount() const override { return m_Steps; }
+
+	void RequirePositions(bool required) override;
+	inline bool DrawsParticles() const override { return true; }
+
+	inline const char* GetName() const override { return "vulkan"; }
+
+private:
+	// The renderer's particles are as large as FluidSolver's
+	static constexpr double s_ParticleRadius = 1.0;
+
+	uint64_t m_Steps = 0;
+
+	// Latest copy from the GPU in particle order and the step it was taken after
+	std::vector<glm::vec3> m_ReadPositions;
+	std::vector<glm::vec3> m_ReadVelocities;
+	std::vector<float> m_ReadDensities;
+	uint64_t m_ReadStep = 0;
+
+	// The copy widened to the streams of SolverView
+	std::vector<double> m_PosX, m_PosY, m_PosZ;
+	std::vector<double> m_VelX, m_VelY, m_VelZ;
+	std::vector<double> m_Density;
+};
\ No newline at end of file
@@ -0,0 +1,119 @@
+//
+//	BENCHMARK ENTRY POINT
+//
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "KernelBench.h"
+#include "SolverBench.h"
+
+static void PrintUsage() {
+	std::cout
+		<< "Usage: Bench [options]\n"
+		<< "  --suite solver|kernels|all   what to run (solver)\n"
+		<< "  --json FILE                  solver report file, stdout when missing\n"
+		<< "\n"
+		<< "Solver suite\n"
+		<< "  --counts N,N,...             particle counts (1000,10000,100000,1000000)\n"
+		<< "  --threads N,N,...            thread counts (1, 2, 4, ... hardware threads)\n"
+		<< "  --steps N                    timed steps per run (20)\n"
+		<< "  --warmup N                   untimed steps per run (5)\n"
+		<< "  --pressure MODEL             stiffness, pcisph or pbf (stiffness)\n"
+		<< "\n"
+		<< "Kernel suite\n"
+		<< "  --particles N                particles (100000)\n"
+		<< "  --pairs N                    pairs at most (1048576)\n"
+		<< "  --seconds S                  time per kernel (0.5)\n";
+}
+
+template<typename T>
+static std::vector<T> ParseList(const char* text) {
+	std::vector<T> values;
+	std::stringstream stream(text);
+	std::string item;
+
+	while (std::getline(stream, item, ','))
+		if (!item.empty())
+			values.push_back(static_cast<T>(std::strtoll(item.c_str(), nullptr, 10)));
+
+	return values;
+}
+
+int main(int argc, char** argv) {
+	std::string suite = "solver";
+	std::string jsonPath;
+
+	SolverBench::Settings solverSettings;
+
+	size_t particles = 100000;
+	size_t pairs = 1 << 20;
+	double seconds = 0.5;
+
+	for (int i = 1; i < argc; i += 2) {
+		if (!std::strcmp(argv[i], "--help")) {
+			PrintUsage();
+			return 0;
+		}
+
+		if (i + 1 >= argc) {
+			std::cerr << "Missing value for " << argv[i] << "\n";
+			return 1;
+		}
+
+		if (!std::strcmp(argv[i], "--suite"))
+			suite = argv[i + 1];
+		else if (!std::strcmp(argv[i], "--json"))
+			jsonPath = argv[i + 1];
+		else if (!std::strcmp(argv[i], "--counts"))
+			solverSettings.particleCounts = ParseList<int>(argv[i + 1]);
+		else if (!std::strcmp(argv[i], "--threads"))
+			solverSettings.threadCounts = ParseList<uint32_t>(argv[i + 1]);
+		else if (!std::strcmp(argv[i], "--steps"))
+			solverSettings.steps = std::atoi(argv[i + 1]);
+		else if (!std::strcmp(argv[i], "--warmup"))
+			solverSettings.warmupSteps = std::atoi(argv[i + 1]);
+		else if (!std::strcmp(argv[i], "--pressure")) {
+			if (!SolverBench::ParsePressureModel(argv[i + 1], solverSettings.pressureModel)) {
+				std::cerr << "Unknown pressure model " << argv[i + 1] << "\n";
+				return 1;
+			}
+		}
+		else if (!std::strcmp(argv[i], "--particles"))
+			particles = std::strtoull(argv[i + 1], nullptr, 10);
+		else if (!std::strcmp(argv[i], "--pairs"))
+			pairs = std::strtoull(argv[i + 1], nullptr, 10);
+		else if (!std::strcmp(argv[i], "--seconds"))
+			seconds = std::atof(argv[i + 1]);
+		else {
+			std::cerr << "Unknown option " << argv[i] << "\n";
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (suite == "kernels" || suite == "all")
+		KernelBench::Run(particles, pairs, seconds);
+
+	if (suite == "solver" || suite == "all") {
+		if (jsonPath.empty()) {
+			// Keep stdout clean for the report
+			SolverBench::Run(solverSettings, std::cout, std::cerr);
+		}
+		else {
+			std::ofstream json(jsonPath);
+			if (!json) {
+				std::cerr << "Failed to open " << jsonPath << "!\n";
+				return 1;
+			}
+
+			SolverBench::Run(solverSettings, json, std::cout);
+		}
+	}
+
+	return 0;
+}
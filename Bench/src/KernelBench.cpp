@@ -0,0 +1,132 @@
+#include "KernelBench.h"
+
+#include <PairKernels.h>
+#include <SphKernels.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Runs func until seconds passed, returns the calls per second
+template<typename Func>
+static double CallsPerSecond(double seconds, Func&& func) {
+	using Clock = std::chrono::steady_clock;
+
+	size_t calls = 0;
+	const Clock::time_point start = Clock::now();
+	double elapsed = 0.0;
+
+	do {
+		func();
+		calls++;
+		elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+	} while (elapsed < seconds);
+
+	return static_cast<double>(calls) / elapsed;
+}
+
+static double MaxDifference(const std::vector<double>& a, const std::vector<double>& b) {
+	double difference = 0.0;
+	for (size_t i = 0; i < a.size(); i++)
+		difference = std::max(difference, std::fabs(a[i] - b[i]));
+
+	return difference;
+}
+
+// Every ISA up to the detected one for the kernel set, the scalar run is the reference
+template<typename Kernels>
+static void RunKernels(const char* name, const ParticleStore& particles, const PairSpan& pairs, const PairForceParams& params, double seconds) {
+	const size_t pairCount = pairs.count;
+
+	std::vector<double> weight(pairCount), deltaVelX(pairCount), deltaVelY(pairCount), deltaVelZ(pairCount);
+	std::vector<double> refWeight, refDeltaVelX, refDeltaVelY, refDeltaVelZ;
+
+	std::printf("%s kernels\n", name);
+	std::printf("%-10s %18s %18s %14s\n", "ISA", "density pairs/s", "force pairs/s", "max diff");
+
+	for (uint8_t level = 0; level <= static_cast<uint8_t>(eng::CpuFeatures::GetSimdLevel()); level++) {
+		const PairKernels kernels{ static_cast<eng::SimdLevel>(level) };
+
+		const double densityRate = CallsPerSecond(seconds, [&]() { kernels.Densities<typename Kernels::Density>(pairs, weight.data()); }) * pairCount;
+		const double forceRate = CallsPerSecond(seconds, [&]() { kernels.PairForces<Kernels>(particles, pairs, params, deltaVelX.data(), deltaVelY.data(), deltaVelZ.data()); }) * pairCount;
+
+		if (level == 0) {
+			refWeight = weight;
+			refDeltaVelX = deltaVelX;
+			refDeltaVelY = deltaVelY;
+			refDeltaVelZ = deltaVelZ;
+		}
+
+		const double difference = std::max({
+			  MaxDifference(weight, refWeight)
+			, MaxDifference(deltaVelX, refDeltaVelX)
+			, MaxDifference(deltaVelY, refDeltaVelY)
+			, MaxDifference(deltaVelZ, refDeltaVelZ)
+		});
+
+		std::printf("%-10s %18.4g %18.4g %14.3g\n", eng::CpuFeatures::GetName(kernels.GetSimdLevel()), densityRate, forceRate, difference);
+	}
+}
+
+void KernelBench::Run(size_t particleCount, size_t pairCount, double seconds) {
+	std::mt19937 randEng(42);
+	std::uniform_real_distribution<double> jitterDist(-0.2, 0.2);
+	std::uniform_real_distribution<double> velDist(-2.0, 2.0);
+	std::uniform_real_distribution<double> densityDist(3.0, 7.0);
+	std::uniform_real_distribution<double> pressureDist(0.0, 100.0);
+
+	// Jittered lattice with a spacing a bit below the radius, close to a settled fluid
+	const double spacing = 0.8;
+	const int side = static_cast<int>(std::ceil(std::cbrt(static_cast<double>(particleCount))));
+
+	ParticleStore particles;
+	particles.Resize(particleCount);
+
+	for (size_t i = 0; i < particleCount; i++) {
+		const int x = static_cast<int>(i % side);
+		const int y = static_cast<int>((i / side) % side);
+		const int z = static_cast<int>(i / (static_cast<size_t>(side) * side));
+
+		particles.SetPos(i, glm::dvec3{ x * spacing + jitterDist(randEng), y * spacing + jitterDist(randEng), z * spacing + jitterDist(randEng) });
+		particles.SetVel(i, glm::dvec3{ velDist(randEng), velDist(randEng), velDist(randEng) });
+		particles.density[i] = densityDist(randEng);
+		particles.pressure[i] = pressureDist(randEng);
+	}
+
+	// Pairs with the lattice neighbours up to 2 cells away, in index order like a neighbour list.
+	// Some of them are out of range, like the pairs inside the skin of a Verlet list.
+	std::vector<uint32_t> first, second;
+	std::vector<double> distance;
+
+	for (size_t i = 0; i < particleCount && first.size() < pairCount; i++)
+		for (int dz = -2; dz <= 2; dz++)
+			for (int dy = -2; dy <= 2; dy++)
+				for (int dx = -2; dx <= 2; dx++) {
+					const long long j = static_cast<long long>(i) + (static_cast<long long>(dz) * side + dy) * side + dx;
+
+					if (j <= static_cast<long long>(i) || j >= static_cast<long long>(particleCount) || first.size() >= pairCount)
+						continue;
+
+					first.push_back(static_cast<uint32_t>(i));
+					second.push_back(static_cast<uint32_t>(j));
+					distance.push_back(glm::distance(particles.Pos(i), particles.Pos(static_cast<size_t>(j))));
+				}
+
+	pairCount = first.size();
+	const size_t inRange = std::count_if(distance.begin(), distance.end(), [](double d) { return d < s_KernelSupport; });
+
+	const PairSpan pairs{ first.data(), second.data(), distance.data(), pairCount };
+
+	PairForceParams params;
+	params.dt = 1.0 / 60.0;
+
+	const eng::SimdLevel detected = eng::CpuFeatures::GetSimdLevel();
+
+	std::printf("Pair kernels, %zu pairs (%zu in range) over %zu particles, detected %s\n", pairCount, inRange, particleCount, eng::CpuFeatures::GetName(detected));
+
+	RunKernels<StandardKernels>("Standard", particles, pairs, params, seconds);
+	RunKernels<WendlandKernels>("Wendland", particles, pairs, params, seconds);
+}
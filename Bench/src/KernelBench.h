@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+
+//
+// Single thread throughput of the PairKernels for every instruction set the CPU supports.
+// Prints pairs per second and the largest difference to the scalar results.
+//
+class KernelBench {
+public:
+	// pairCount pairs over particleCount particles, every kernel runs for about seconds
+	static void Run(size_t particleCount, size_t pairCount, double seconds);
+};
@@ -0,0 +1,139 @@
+#include "SolverBench.h"
+
+#include <CpuFeatures.h>
+#include <FluidSolver.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+// Particles spawned by the default box, the box grows with the count to keep the spacing
+static constexpr double s_BaseParticleCount = 1000.0;
+
+std::vector<uint32_t> SolverBench::DefaultThreadCounts() {
+	const uint32_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	std::vector<uint32_t> counts;
+	for (uint32_t threads = 1; threads < hardwareThreads; threads *= 2)
+		counts.push_back(threads);
+	counts.push_back(hardwareThreads);
+
+	return counts;
+}
+
+bool SolverBench::ParsePressureModel(const char* name, PressureModel& model) {
+	for (PressureModel candidate : { PressureModel::Stiffness, PressureModel::Pcisph, PressureModel::Pbf }) {
+		if (!std::strcmp(name, PressureModelName(candidate))) {
+			model = candidate;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+const char* SolverBench::PressureModelName(PressureModel model) {
+	switch (model) {
+	case PressureModel::Pcisph:
+		return "pcisph";
+	case PressureModel::Pbf:
+		return "pbf";
+	default:
+		return "stiffness";
+	}
+}
+
+void SolverBench::Run(const Settings& settings, std::ostream& json, std::ostream& log) {
+	const std::vector<uint32_t> threadCounts = settings.threadCounts.empty() ? DefaultThreadCounts() : settings.threadCounts;
+
+	json << "{\n";
+	json << "  \"benchmark\": \"solver\",\n";
+	json << "  \"simd\": \"" << eng::CpuFeatures::GetName(eng::CpuFeatures::GetSimdLevel()) << "\",\n";
+	json << "  \"physicalCores\": " << eng::JobSystem::GetPhysicalCoreCount() << ",\n";
+	json << "  \"hardwareThreads\": " << std::thread::hardware_concurrency() << ",\n";
+	json << "  \"warmupSteps\": " << settings.warmupSteps << ",\n";
+	json << "  \"steps\": " << settings.steps << ",\n";
+	json << "  \"dt\": " << settings.dt << ",\n";
+	json << "  \"pressureModel\": \"" << PressureModelName(settings.pressureModel) << "\",\n";
+	json << "  \"runs\": [";
+
+	bool firstRun = true;
+
+	for (int particleCount : settings.particleCounts) {
+		for (uint32_t threadCount : threadCounts) {
+			SimulationParams params;
+			params.particleCount = particleCount;
+			params.threadCount = threadCount;
+			params.pressureModel = settings.pressureModel;
+			params.boxScale = std::cbrt(particleCount / s_BaseParticleCount);
+
+			log << "N = " << particleCount << ", threads = " << threadCount << "..." << std::flush;
+
+			// Same spawn for every thread count
+			std::srand(1);
+
+			FluidSolver solver;
+			solver.Start(params);
+
+			for (int step = 0; step < settings.warmupSteps; step++)
+				solver.Update(params, settings.dt);
+
+			const size_t rebuildsBefore = solver.GetNeighbours().GetRebuildCount();
+			solver.ResetStats();
+
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+			for (int step = 0; step < settings.steps; step++)
+				solver.Update(params, settings.dt);
+
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			const SolverStats& stats = solver.GetStats();
+			const double steps = static_cast<double>(std::max<size_t>(stats.steps, 1));
+
+			// Nanoseconds per particle and step
+			auto perParticle = [&](double phaseSeconds) { return phaseSeconds * 1e9 / (steps * particleCount); };
+
+			const ParticleStore& particles = solver.GetParticles();
+			const NeighbourList& neighbours = solver.GetNeighbours();
+
+			log << " " << perParticle(seconds) << " ns/particle/step\n";
+
+			json << (firstRun ? "\n" : ",\n");
+			firstRun = false;
+
+			json << "    {\n";
+			json << "      \"particles\": " << particleCount << ",\n";
+			json << "      \"threads\": " << solver.GetJobSystem().GetThreadCount() << ",\n";
+			json << "      \"boxScale\": " << params.boxScale << ",\n";
+			json << "      \"seconds\": " << seconds << ",\n";
+			json << "      \"pressureSeconds\": " << stats.pressureSeconds << ",\n";
+			json << "      \"pressureIterations\": " << stats.pressureIterations << ",\n";
+			json << "      \"nsPerParticleStep\": {\n";
+			json << "        \"total\": " << perParticle(seconds) << ",\n";
+			json << "        \"reorder\": " << perParticle(stats.reorderSeconds) << ",\n";
+			json << "        \"neighbours\": " << perParticle(stats.neighbourSeconds) << ",\n";
+			json << "        \"density\": " << perParticle(stats.densitySeconds) << ",\n";
+			json << "        \"forces\": " << perParticle(stats.forceSeconds) << ",\n";
+			json << "        \"pressure\": " << perParticle(stats.pressureSeconds) << ",\n";
+			json << "        \"integration\": " << perParticle(stats.integrationSeconds) << "\n";
+			json << "      },\n";
+			json << "      \"pressureIterationsPerStep\": " << static_cast<double>(stats.pressureIterations) / steps << ",\n";
+			json << "      \"pairsEvaluatedPerStep\": " << static_cast<double>(stats.pairsEvaluated) / steps << ",\n";
+			json << "      \"listedPairs\": " << neighbours.PairCount() << ",\n";
+			json << "      \"neighbourRebuilds\": " << neighbours.GetRebuildCount() - rebuildsBefore << ",\n";
+			json << "      \"neighbourRebuildRatio\": " << static_cast<double>(neighbours.GetRebuildCount() - rebuildsBefore) / steps << ",\n";
+			json << "      \"neighbourSkin\": " << neighbours.GetSkin() << ",\n";
+			json << "      \"memoryBytes\": {\n";
+			json << "        \"particles\": " << particles.MemoryFootprint() << ",\n";
+			json << "        \"neighbours\": " << neighbours.MemoryFootprint() << ",\n";
+			json << "        \"total\": " << solver.MemoryFootprint() << "\n";
+			json << "      }\n";
+			json << "    }";
+		}
+	}
+
+	json << "\n  ]\n}\n";
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <FluidSolver.h>
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+//
+// Scaling runs of the FluidSolver over particle and thread counts.
+// Every phase of FluidSolver::Update is timed on its own, results are written as JSON.
+//
+class SolverBench {
+public:
+	struct Settings {
+		std::vector<int> particleCounts{ 1000, 10000, 100000, 1000000 };
+
+		// Empty runs 1, 2, 4, ... up to the hardware thread count
+		std::vector<uint32_t> threadCounts;
+
+		int warmupSteps = 5;
+		int steps = 20;
+		double dt = 1.0 / 60.0;
+
+		PressureModel pressureModel = PressureModel::Stiffness;
+	};
+
+	// Progress goes to log, the JSON report to json
+	static void Run(const Settings& settings, std::ostream& json, std::ostream& log);
+
+	// 1, 2, 4, ... up to and including the hardware thread count
+	static std::vector<uint32_t> DefaultThreadCounts();
+
+	// Name of the --pressure option, false for unknown names
+	static bool ParsePressureModel(const char* name, PressureModel& model);
+	static const char* PressureModelName(PressureModel model);
+};
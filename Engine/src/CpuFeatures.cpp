@@ -0,0 +1,81 @@
+#include "pch.h"
+#include "CpuFeatures.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+namespace eng {
+
+	static void Cpuid(uint32_t leaf, uint32_t subLeaf, uint32_t regs[4]) {
+#ifdef _MSC_VER
+		int info[4];
+		__cpuidex(info, static_cast<int>(leaf), static_cast<int>(subLeaf));
+		for (int i = 0; i < 4; i++)
+			regs[i] = static_cast<uint32_t>(info[i]);
+#else
+		__cpuid_count(leaf, subLeaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+	}
+
+	// Register state the OS saves on context switches
+	static uint64_t ReadXcr0() {
+#ifdef _MSC_VER
+		return _xgetbv(0);
+#else
+		uint32_t eax, edx;
+		__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+	}
+
+	static SimdLevel DetectSimdLevel() {
+		uint32_t regs[4];
+
+		Cpuid(0, 0, regs);
+		const uint32_t maxLeaf = regs[0];
+		if (maxLeaf < 7)
+			return SimdLevel::Scalar;
+
+		Cpuid(1, 0, regs);
+		const bool osxsave = regs[2] & (1u << 27);
+		const bool avx = regs[2] & (1u << 28);
+		if (!osxsave || !avx)
+			return SimdLevel::Scalar;
+
+		const uint64_t xcr0 = ReadXcr0();
+		const bool ymmState = (xcr0 & 0x6) == 0x6;
+		const bool zmmState = (xcr0 & 0xe6) == 0xe6;
+
+		Cpuid(7, 0, regs);
+		const bool avx2 = regs[1] & (1u << 5);
+		const bool avx512f = regs[1] & (1u << 16);
+
+		if (avx512f && zmmState)
+			return SimdLevel::AVX512;
+
+		if (avx2 && ymmState)
+			return SimdLevel::AVX2;
+
+		return SimdLevel::Scalar;
+	}
+
+	ENGINE_API SimdLevel CpuFeatures::GetSimdLevel() {
+		static const SimdLevel s_Level = DetectSimdLevel();
+		return s_Level;
+	}
+
+	ENGINE_API const char* CpuFeatures::GetName(SimdLevel level) {
+		switch (level) {
+		case SimdLevel::AVX2:
+			return "AVX2";
+		case SimdLevel::AVX512:
+			return "AVX-512";
+		default:
+			return "Scalar";
+		}
+	}
+
+}
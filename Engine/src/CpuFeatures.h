@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Engine.h"
+
+// STL
+#include <cstdint>
+//
+
+namespace eng {
+
+	/// <summary>
+	/// Vector instruction sets the kernels are built for, ordered by width
+	/// </summary>
+	enum class SimdLevel : uint8_t {
+		Scalar = 0,
+		AVX2,
+		AVX512
+	};
+
+	/// <summary>
+	/// Runtime detection of the instruction sets usable by the CPU and the OS
+	/// </summary>
+	class CpuFeatures {
+	public:
+		/// <summary>
+		/// Widest instruction set supported, detected once
+		/// </summary>
+		ENGINE_API static SimdLevel GetSimdLevel();
+
+		ENGINE_API static const char* GetName(SimdLevel level);
+	};
+
+}
@@ -0,0 +1,13 @@
+#include "pch.h"
+#include "Engine.h"
+
+namespace eng {
+	ENGINE_API int Run() {
+		return 11223;
+	}
+
+	ENGINE_API int FK() {
+		std::cout << "1234";
+		return 32123;
+	}
+}
@@ -1,18 +1,14 @@
 #pragma once
 #include "pch.h"
 
-//
-// Hack for now
-//
+#ifdef ENGINE_API_EXPORT
 #define ENGINE_API __declspec(dllexport)
+#else
+#define ENGINE_API __declspec(dllimport)
+#endif
 
 namespace eng {
-	ENGINE_API int Run() {
-		return 11223;
-	}
+	ENGINE_API int Run();
 
-	ENGINE_API int FK() {
-		std::cout << "1234";
-		return 32123;
-	}
+	ENGINE_API int FK();
 }
@@ -0,0 +1,54 @@
+#include "pch.h"
+#include "FixedTimestep.h"
+
+// STL
+#include <cmath>
+#include <stdexcept>
+//
+
+namespace eng {
+
+	ENGINE_API FixedTimestep::FixedTimestep(double stepSize, uint32_t maxSubsteps) {
+		SetStepSize(stepSize);
+		SetMaxSubsteps(maxSubsteps);
+	}
+
+	ENGINE_API uint32_t FixedTimestep::Advance(double frameTime) {
+		if (frameTime > 0.0)
+			m_Accumulator += frameTime;
+
+		uint32_t steps = 0;
+
+		while (m_Accumulator >= m_StepSize && steps < m_MaxSubsteps) {
+			m_Accumulator -= m_StepSize;
+			steps++;
+		}
+
+		// Whatever is still owed after the cap is dropped, keeping only the partial step
+		if (m_Accumulator >= m_StepSize) {
+			const double kept = std::fmod(m_Accumulator, m_StepSize);
+			m_DroppedTime += m_Accumulator - kept;
+			m_Accumulator = kept;
+		}
+
+		m_LastSubsteps = steps;
+		m_TotalSubsteps += steps;
+
+		return steps;
+	}
+
+	ENGINE_API void FixedTimestep::Reset() {
+		m_Accumulator = 0.0;
+		m_DroppedTime = 0.0;
+		m_LastSubsteps = 0;
+		m_TotalSubsteps = 0;
+	}
+
+	ENGINE_API void FixedTimestep::SetStepSize(double stepSize) {
+		if (stepSize <= 0.0)
+			throw std::runtime_error("Failed to set the step size, it has to be positive!");
+
+		m_StepSize = stepSize;
+	}
+
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Engine.h"
+
+// STL
+#include <cstdint>
+//
+
+namespace eng {
+
+	/// <summary>
+	/// Fixed step scheduler.
+	///
+	/// Real frame time is added to an accumulator and paid out in steps of a fixed size,
+	/// so the simulated time follows the wall clock whatever the frame rate is.
+	/// A frame never runs more than maxSubsteps steps, the time past that is dropped
+	/// instead of piling up (spiral of death) and is reported by GetDroppedTime.
+	/// </summary>
+	class FixedTimestep {
+	public:
+		ENGINE_API explicit FixedTimestep(double stepSize = 1.0 / 60.0, uint32_t maxSubsteps = 4);
+
+		/// <summary>
+		/// Adds the frame time and returns how many steps of GetStepSize() are due this frame
+		/// </summary>
+		/// <param name="frameTime">Real seconds since the previous call</param>
+		ENGINE_API uint32_t Advance(double frameTime);
+
+		/// <summary>
+		/// Empties the accumulator and the counters
+		/// </summary>
+		ENGINE_API void Reset();
+
+		ENGINE_API void SetStepSize(double stepSize);
+
+		inline void		SetMaxSubsteps(uint32_t maxSubsteps) { m_MaxSubsteps = maxSubsteps ? maxSubsteps : 1; }
+		inline uint32_t	GetMaxSubsteps() const { return m_MaxSubsteps; }
+
+		inline double	GetStepSize() const { return m_StepSize; }
+
+		/// <summary>
+		/// Steps returned by the last Advance
+		/// </summary>
+		inline uint32_t GetLastSubsteps() const { return m_LastSubsteps; }
+
+		inline uint64_t GetTotalSubsteps() const { return m_TotalSubsteps; }
+
+		/// <summary>
+		/// Seconds thrown away by the substep cap since the last Reset
+		/// </summary>
+		inline double	GetDroppedTime() const { return m_DroppedTime; }
+
+		/// <summary>
+		/// Part of a step left in the accumulator, in [0, 1), usable to interpolate between steps
+		/// </summary>
+		inline double	GetAlpha() const { return m_Accumulator / m_StepSize; }
+
+	private:
+		double m_StepSize;
+		uint32_t m_MaxSubsteps;
+
+		double m_Accumulator = 0.0;
+		double m_DroppedTime = 0.0;
+
+		uint32_t m_LastSubsteps = 0;
+		uint64_t m_TotalSubsteps = 0;
+	};
+
+}
@@ -0,0 +1,210 @@
+#include "pch.h"
+#include "JobSystem.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#endif
+
+namespace eng {
+
+	// Identifies the pool / queue of the current thread, external threads have no pool
+	static thread_local const JobSystem* t_Pool = nullptr;
+	static thread_local uint32_t t_QueueIndex = 0;
+
+	ENGINE_API JobSystem::JobSystem(uint32_t threadCount) {
+		StartWorkers(threadCount);
+	}
+
+	ENGINE_API JobSystem::~JobSystem() {
+		StopWorkers();
+	}
+
+	ENGINE_API void JobSystem::ParallelFor(size_t begin, size_t end, const RangeFunc& func) {
+		ParallelFor(begin, end, m_ChunkSize, func);
+	}
+
+	ENGINE_API void JobSystem::ParallelFor(size_t begin, size_t end, size_t chunkSize, const RangeFunc& func) {
+		if (begin >= end)
+			return;
+
+		chunkSize = chunkSize ? chunkSize : 1;
+		const size_t chunkCount = (end - begin + chunkSize - 1) / chunkSize;
+
+		// Not worth waking anybody up
+		if (chunkCount == 1 || m_Workers.empty()) {
+			func(begin, end);
+			return;
+		}
+
+		const uint32_t ownQueue = GetThreadIndex();
+		const uint32_t queueCount = static_cast<uint32_t>(m_Queues.size());
+
+		Batch batch;
+		batch.remaining.store(chunkCount, std::memory_order_relaxed);
+
+		// Count before publishing, a worker may pick a chunk up as soon as it is pushed
+		{
+			std::lock_guard<std::mutex> lock(m_SleepMutex);
+			m_QueuedJobs.fetch_add(chunkCount, std::memory_order_release);
+		}
+
+		// Deal chunks round-robin so every worker starts with local work,
+		// imbalance afterwards is fixed by stealing
+		for (size_t c = 0; c < chunkCount; c++) {
+			Job job;
+			job.func = &func;
+			job.begin = begin + c * chunkSize;
+			job.end = std::min(job.begin + chunkSize, end);
+			job.batch = &batch;
+
+			Push(static_cast<uint32_t>((ownQueue + c) % queueCount), job);
+		}
+
+		m_SleepCv.notify_all();
+
+		// Help out until all chunks of this call are done
+		while (batch.remaining.load(std::memory_order_acquire) != 0)
+			if (!TryRunOne(ownQueue))
+				std::this_thread::yield();
+
+		if (batch.error)
+			std::rethrow_exception(batch.error);
+	}
+
+	ENGINE_API void JobSystem::SetThreadCount(uint32_t threadCount) {
+		StopWorkers();
+		StartWorkers(threadCount);
+	}
+
+	ENGINE_API uint32_t JobSystem::GetThreadIndex() const {
+		if (t_Pool == this)
+			return t_QueueIndex;
+
+		return static_cast<uint32_t>(m_Queues.size()) - 1;
+	}
+
+	ENGINE_API uint32_t JobSystem::GetPhysicalCoreCount() {
+#ifdef _WIN32
+		DWORD length = 0;
+		GetLogicalProcessorInformationEx(RelationProcessorCore, nullptr, &length);
+
+		std::vector<uint8_t> buffer(length);
+		auto info = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data());
+
+		if (length && GetLogicalProcessorInformationEx(RelationProcessorCore, info, &length)) {
+			uint32_t cores = 0;
+
+			for (DWORD offset = 0; offset < length; cores++)
+				offset += reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data() + offset)->Size;
+
+			if (cores)
+				return cores;
+		}
+#endif
+		return std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	void JobSystem::StartWorkers(uint32_t threadCount) {
+		if (!threadCount)
+			threadCount = GetPhysicalCoreCount();
+
+		m_Stop = false;
+
+		m_Queues.clear();
+		for (uint32_t i = 0; i < threadCount; i++)
+			m_Queues.push_back(std::make_unique<WorkQueue>());
+
+		for (uint32_t i = 0; i + 1 < threadCount; i++)
+			m_Workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+	}
+
+	void JobSystem::StopWorkers() {
+		{
+			std::lock_guard<std::mutex> lock(m_SleepMutex);
+			m_Stop = true;
+		}
+		m_SleepCv.notify_all();
+
+		for (auto& worker : m_Workers)
+			worker.join();
+
+		m_Workers.clear();
+	}
+
+	void JobSystem::WorkerLoop(uint32_t index) {
+		t_Pool = this;
+		t_QueueIndex = index;
+
+		while (true) {
+			if (TryRunOne(index))
+				continue;
+
+			std::unique_lock<std::mutex> lock(m_SleepMutex);
+			m_SleepCv.wait(lock, [this]() { return m_Stop || m_QueuedJobs.load(std::memory_order_acquire) != 0; });
+
+			if (m_Stop)
+				return;
+		}
+	}
+
+	void JobSystem::Push(uint32_t queueIndex, const Job& job) {
+		WorkQueue& queue = *m_Queues[queueIndex];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(job);
+	}
+
+	bool JobSystem::Pop(uint32_t queueIndex, Job& job) {
+		WorkQueue& queue = *m_Queues[queueIndex];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+
+		if (queue.jobs.empty())
+			return false;
+
+		// LIFO for the owner, the most recently pushed range is still warm in cache
+		job = queue.jobs.back();
+		queue.jobs.pop_back();
+		return true;
+	}
+
+	bool JobSystem::Steal(uint32_t thiefIndex, Job& job) {
+		const uint32_t queueCount = static_cast<uint32_t>(m_Queues.size());
+
+		for (uint32_t i = 1; i < queueCount; i++) {
+			WorkQueue& victim = *m_Queues[(thiefIndex + i) % queueCount];
+			std::lock_guard<std::mutex> lock(victim.mutex);
+
+			if (victim.jobs.empty())
+				continue;
+
+			job = victim.jobs.front();
+			victim.jobs.pop_front();
+			return true;
+		}
+
+		return false;
+	}
+
+	bool JobSystem::TryRunOne(uint32_t queueIndex) {
+		Job job;
+
+		if (!Pop(queueIndex, job) && !Steal(queueIndex, job))
+			return false;
+
+		m_QueuedJobs.fetch_sub(1, std::memory_order_acq_rel);
+
+		// A throwing chunk must still count as done, or the caller waits forever and its func goes out of scope under the other workers
+		try {
+			(*job.func)(job.begin, job.end);
+		}
+		catch (...) {
+			if (!job.batch->failed.exchange(true, std::memory_order_relaxed))
+				job.batch->error = std::current_exception();
+		}
+
+		job.batch->remaining.fetch_sub(1, std::memory_order_acq_rel);
+		return true;
+	}
+
+}
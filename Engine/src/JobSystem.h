@@ -0,0 +1,118 @@
+#pragma once
+
+#include "Engine.h"
+
+// STL
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+//
+
+namespace eng {
+
+	/// <summary>
+	/// Work-stealing thread pool.
+	///
+	/// Every worker owns a deque of jobs, it pops from the back of its own deque
+	/// and steals from the front of the others when it runs dry. The thread that
+	/// calls ParallelFor takes part in the work until its jobs are done, so
+	/// nested ParallelFor calls from inside a job do not deadlock.
+	/// </summary>
+	class JobSystem {
+	public:
+		using RangeFunc = std::function<void(size_t begin, size_t end)>;
+
+		/// <summary>
+		/// Starts the workers, 0 picks one thread per physical core
+		/// </summary>
+		/// <param name="threadCount">Total threads including the calling thread</param>
+		ENGINE_API explicit JobSystem(uint32_t threadCount = 0);
+		ENGINE_API ~JobSystem();
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		/// <summary>
+		/// Splits [begin, end) into chunks of chunkSize and runs func(chunkBegin, chunkEnd)
+		/// on the pool. Returns once every chunk has finished. The first exception a chunk
+		/// throws is rethrown here after that, the other chunks still run.
+		/// </summary>
+		ENGINE_API void ParallelFor(size_t begin, size_t end, size_t chunkSize, const RangeFunc& func);
+
+		/// <summary>
+		/// ParallelFor with the configured default chunk size
+		/// </summary>
+		ENGINE_API void ParallelFor(size_t begin, size_t end, const RangeFunc& func);
+
+		/// <summary>
+		/// Stops the current workers and starts threadCount - 1 new ones
+		/// </summary>
+		ENGINE_API void SetThreadCount(uint32_t threadCount);
+
+		inline uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_Workers.size()) + 1; }
+
+		inline void		SetChunkSize(size_t chunkSize) { m_ChunkSize = chunkSize ? chunkSize : 1; }
+		inline size_t	GetChunkSize() const { return m_ChunkSize; }
+
+		/// <summary>
+		/// Index of the calling thread inside this pool, GetThreadCount() - 1 for external threads.
+		/// Stable for the duration of a job, usable to pick per-thread scratch buffers.
+		/// </summary>
+		ENGINE_API uint32_t GetThreadIndex() const;
+
+		ENGINE_API static uint32_t GetPhysicalCoreCount();
+
+	private:
+		// Chunks of one ParallelFor call, lives on the calling thread's stack until all of them are done
+		struct Batch {
+			std::atomic<size_t> remaining{ 0 };
+
+			// The first chunk to throw claims the slot, the caller reads it once remaining is 0
+			std::atomic<bool> failed{ false };
+			std::exception_ptr error;
+		};
+
+		struct Job {
+			const RangeFunc* func = nullptr;
+			size_t begin = 0;
+			size_t end = 0;
+			Batch* batch = nullptr;
+		};
+
+		struct WorkQueue {
+			std::mutex mutex;
+			std::deque<Job> jobs;
+		};
+
+		void StartWorkers(uint32_t threadCount);
+		void StopWorkers();
+
+		void WorkerLoop(uint32_t index);
+
+		void Push(uint32_t queueIndex, const Job& job);
+		bool Pop(uint32_t queueIndex, Job& job);
+		bool Steal(uint32_t thiefIndex, Job& job);
+		bool TryRunOne(uint32_t queueIndex);
+
+		std::vector<std::thread> m_Workers;
+
+		// One queue per worker plus a shared one for external threads (last index)
+		std::vector<std::unique_ptr<WorkQueue>> m_Queues;
+
+		std::atomic<size_t> m_QueuedJobs{ 0 };
+		std::atomic<bool> m_Stop{ false };
+
+		std::mutex m_SleepMutex;
+		std::condition_variable m_SleepCv;
+
+		size_t m_ChunkSize = 256;
+	};
+
+}
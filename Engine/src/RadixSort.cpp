@@ -0,0 +1,94 @@
+#include "pch.h"
+#include "RadixSort.h"
+
+namespace eng {
+
+	static constexpr uint32_t s_RadixBits = 8;
+	static constexpr uint32_t s_Buckets = 1u << s_RadixBits;
+
+	ENGINE_API void RadixSort(JobSystem& jobSystem, std::vector<uint32_t>& keys, std::vector<uint32_t>& values, uint32_t keyBits) {
+		const size_t count = keys.size();
+		if (count < 2)
+			return;
+
+		// One histogram per block, blocks are scattered in order so the sort stays stable
+		const size_t blockCount = std::min<size_t>(jobSystem.GetThreadCount() * 4, (count + 1023) / 1024);
+		const size_t blockSize = (count + blockCount - 1) / blockCount;
+
+		std::vector<uint32_t> keysTemp(count);
+		std::vector<uint32_t> valuesTemp(count);
+		std::vector<size_t> offsets(blockCount * s_Buckets);
+
+		std::vector<uint32_t>* srcKeys = &keys;
+		std::vector<uint32_t>* srcValues = &values;
+		std::vector<uint32_t>* dstKeys = &keysTemp;
+		std::vector<uint32_t>* dstValues = &valuesTemp;
+
+		for (uint32_t shift = 0; shift < keyBits; shift += s_RadixBits) {
+			const uint32_t* inKeys = srcKeys->data();
+
+			std::fill(offsets.begin(), offsets.end(), 0);
+
+			jobSystem.ParallelFor(0, blockCount, 1, [&](size_t begin, size_t end) {
+				for (size_t block = begin; block < end; block++) {
+					size_t* histogram = offsets.data() + block * s_Buckets;
+					const size_t last = std::min(count, (block + 1) * blockSize);
+
+					for (size_t i = block * blockSize; i < last; i++)
+						histogram[(inKeys[i] >> shift) & (s_Buckets - 1)]++;
+				}
+			});
+
+			// Exclusive prefix sum, bucket major so block b writes after blocks [0, b) inside each bucket
+			size_t sum = 0;
+			bool singleBucket = false;
+
+			for (uint32_t bucket = 0; bucket < s_Buckets; bucket++) {
+				size_t bucketCount = 0;
+
+				for (size_t block = 0; block < blockCount; block++) {
+					size_t& offset = offsets[block * s_Buckets + bucket];
+					const size_t blockBucketCount = offset;
+
+					offset = sum;
+					sum += blockBucketCount;
+					bucketCount += blockBucketCount;
+				}
+
+				if (bucketCount == count)
+					singleBucket = true;
+			}
+
+			// Nothing would move
+			if (singleBucket)
+				continue;
+
+			const uint32_t* inValues = srcValues->data();
+			uint32_t* outKeys = dstKeys->data();
+			uint32_t* outValues = dstValues->data();
+
+			jobSystem.ParallelFor(0, blockCount, 1, [&](size_t begin, size_t end) {
+				for (size_t block = begin; block < end; block++) {
+					size_t* offset = offsets.data() + block * s_Buckets;
+					const size_t last = std::min(count, (block + 1) * blockSize);
+
+					for (size_t i = block * blockSize; i < last; i++) {
+						const size_t dst = offset[(inKeys[i] >> shift) & (s_Buckets - 1)]++;
+						outKeys[dst] = inKeys[i];
+						outValues[dst] = inValues[i];
+					}
+				}
+			});
+
+			std::swap(srcKeys, dstKeys);
+			std::swap(srcValues, dstValues);
+		}
+
+		// Odd number of passes ran, the result sits in the scratch buffers
+		if (srcKeys != &keys) {
+			keys.swap(keysTemp);
+			values.swap(valuesTemp);
+		}
+	}
+
+}
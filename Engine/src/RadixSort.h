@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Engine.h"
+#include "JobSystem.h"
+
+// STL
+#include <cstdint>
+#include <vector>
+//
+
+namespace eng {
+
+	/// <summary>
+	/// Parallel LSD radix sort of 32 bit keys with a 32 bit payload, 8 bits per pass.
+	/// Every pass is stable, so values with equal keys keep their relative order.
+	/// Passes where all keys share the same digit are skipped.
+	/// </summary>
+	/// <param name="keys">Sorted in place</param>
+	/// <param name="values">Moved along with their keys, must be as long as keys</param>
+	/// <param name="keyBits">Only the low keyBits bits of the keys are looked at</param>
+	ENGINE_API void RadixSort(JobSystem& jobSystem, std::vector<uint32_t>& keys, std::vector<uint32_t>& values, uint32_t keyBits = 32);
+
+}
@@ -0,0 +1,401 @@
+//
+//	HEADLESS ENTRY POINT
+//	Runs a solver backend for a fixed number of steps without a window or a GPU
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <FixedTimestep.h>
+
+#include <CpuSolver.h>
+#include <SolverCrossCheck.h>
+#include <SolverRegistry.h>
+#include <SpatialGrid.h>
+
+struct RunOptions {
+	SimulationParams params;
+	int steps = 1000;
+	double dt = 1.0 / 60.0;
+	double frameTime = 0.0;
+	int maxSubsteps = 4;
+	unsigned seed = 1;
+	int reportInterval = 0;
+	std::string output;
+
+	// Fails the run when two particles end up closer than this, 0 only reports the spacing
+	double minSpacing = 0.0;
+
+	// Empty picks SolverRegistry::Default, no cross-check without a name
+	std::string solver;
+	std::string crossCheck;
+};
+
+static const char* PressureModelName(PressureModel model) {
+	switch (model) {
+	case PressureModel::Pcisph:
+		return "pcisph";
+	case PressureModel::Pbf:
+		return "pbf";
+	default:
+		return "stiffness";
+	}
+}
+
+// Nearest neighbours of the final particles, collapsed or stacked particles show up here
+// long before they show up in the density error
+struct SpacingReport {
+	double closestPair = 0.0;
+	double meanNearest = 0.0;
+	size_t coincidentPairs = 0;
+};
+
+// Pairs closer than this count as coincident, the particles have a radius of 1
+static constexpr double s_CoincidentDistance = 0.01;
+
+static SpacingReport MeasureSpacing(const SolverView& particles) {
+	SpacingReport report;
+	const size_t count = particles.Size();
+
+	if (count < 2)
+		return report;
+
+	glm::dvec3 boxMin = particles.Pos(0);
+	glm::dvec3 boxMax = boxMin;
+
+	for (size_t i = 1; i < count; i++) {
+		boxMin = glm::min(boxMin, particles.Pos(i));
+		boxMax = glm::max(boxMax, particles.Pos(i));
+	}
+
+	// Neighbours further than the kernel support don't interact, the 27 cells around a particle hold them all
+	SpatialGrid grid;
+	grid.Resize(boxMin, boxMax, s_KernelSupport);
+	grid.Build(count, [&](size_t i) { return particles.Pos(i); });
+
+	double nearestSum = 0.0;
+	size_t nearestCount = 0;
+	report.closestPair = s_KernelSupport;
+
+	for (size_t i = 0; i < count; i++) {
+		const glm::dvec3 pos = particles.Pos(i);
+		double nearest = s_KernelSupport;
+
+		grid.ForEachNeighbour(pos, [&](size_t j) {
+			if (j == i)
+				return;
+
+			const double distance = glm::length(particles.Pos(j) - pos);
+			nearest = std::min(nearest, distance);
+
+			if (j > i && distance < s_CoincidentDistance)
+				report.coincidentPairs++;
+		});
+
+		if (nearest < s_KernelSupport) {
+			nearestSum += nearest;
+			nearestCount++;
+		}
+
+		report.closestPair = std::min(report.closestPair, nearest);
+	}
+
+	report.meanNearest = nearestCount ? nearestSum / nearestCount : 0.0;
+	return report;
+}
+
+static void PrintUsage() {
+	std::cout
+		<< "Usage: Headless [options]\n"
+		<< "  --particles N          particle count (1000)\n"
+		<< "  --steps N              steps to run (1000)\n"
+		<< "  --dt SECONDS           fixed time step (1/60)\n"
+		<< "  --frame-time SECONDS   run --steps frames of this length through the fixed step scheduler (off)\n"
+		<< "  --max-substeps N       substep cap per frame with --frame-time (4)\n"
+		<< "  --threads N            solver threads, 0 = one per physical core (0)\n"
+		<< "  --seed N               spawn seed (1)\n"
+		<< "  --velocity X Y Z       mean spawn velocity (0 0 0)\n"
+		<< "  --viscosity V          (0.1)\n"
+		<< "  --rest-density V       (5)\n"
+		<< "  --stiffness V          (3)\n"
+		<< "  --damping V            (0.98)\n"
+		<< "  --box-scale S          scales the box and the spawn volume (1)\n"
+		<< "  --pressure MODEL       stiffness, pcisph or pbf (stiffness)\n"
+		<< "  --density-tolerance V  mean compression of the compressed particles pcisph leaves (0.01)\n"
+		<< "  --max-iterations N     pcisph iteration cap per step (8)\n"
+		<< "  --pbf-iterations N     pbf constraint projections per step (4)\n"
+		<< "  --no-gravity\n"
+		<< "  --no-collisions\n"
+		<< "  --report N             print progress every N steps (off)\n"
+		<< "  --output FILE          write the final positions as CSV\n"
+		<< "  --min-spacing D        fail when two particles end up closer than D (off)\n"
+		<< "  --solver NAME          solver backend (" << SolverRegistry::Default() << ")\n"
+		<< "  --cross-check NAME     run a second backend along and report the divergence (off)\n"
+		<< "Backends:";
+
+	for (const SolverRegistry::Entry& entry : SolverRegistry::GetEntries())
+		std::cout << " " << entry.name;
+
+	std::cout << "\n";
+}
+
+static bool ParseArgs(int argc, char** argv, RunOptions& options) {
+	for (int i = 1; i < argc; i++) {
+		const char* arg = argv[i];
+
+		// Options taking values check that enough arguments are left
+		auto value = [&](int offset) -> const char* {
+			if (i + offset >= argc)
+				throw std::runtime_error(std::string("Missing value for ") + arg + "!");
+			return argv[i + offset];
+		};
+
+		if (!std::strcmp(arg, "--particles"))
+			options.params.particleCount = std::atoi(value(1)), i++;
+		else if (!std::strcmp(arg, "--steps"))
+			options.steps = std::atoi(value(1)), i++;
+		else if (!std::strcmp(arg, "--dt"))
+			options.dt = std::atof(value(1)), i++;
+		else if (!std::strcmp(arg, "--frame-time"))
+			options.frameTime = std::atof(value(1)), i++;
+		else if (!std::strcmp(arg, "--max-substeps"))
+			options.maxSubsteps = std::atoi(value(1)), i++;
+		else if (!std::strcmp(arg, "--threads"))
+			options.params.threadCount = static_cast<uint32_t>(std::atoi(value(1))), i++;
+		else if (!std::strcmp(arg, "--seed"))
+			options.seed = static_cast<unsigned>(std::strtoul(value(1), nullptr, 10)), i++;
+		else if (!std::strcmp(arg, "--velocity")) {
+			options.params.startVelocity = glm::dvec3{ std::atof(value(1)), std::atof(value(2)), std::atof(value(3)) };
+			i += 3;
+		}
+		else if (!std::strcmp(arg, "--viscosity"))
+			options.params.viscosity = std::atof(value(1)), i++;
+		else if (!std::strcmp(arg, "--rest-density"))
+			options.params.restDensity = std::atof(value(1)), i++;
+		else if (!std::strcmp(arg, "--stiffness"))
+			options.params.stiffness = std::atof(value(1)), i++;
+		else if (!std::strcmp(arg, "--damping"))
+			options.params.damping = std::atof(value(1)), i++;
+		else if (!std::strcmp(arg, "--box-scale"))
+			options.params.boxScale = std::atof(value(1)), i++;
+		else if (!std::strcmp(arg, "--pressure")) {
+			const char* model = value(1);
+
+			if (!std::strcmp(model, "stiffness"))
+				options.params.pressureModel = PressureModel::Stiffness;
+			else if (!std::strcmp(model, "pcisph"))
+				options.params.pressureModel = PressureModel::Pcisph;
+			else if (!std::strcmp(model, "pbf"))
+				options.params.pressureModel = PressureModel::Pbf;
+			else
+				throw std::runtime_error(std::string("Unknown pressure model ") + model + "!");
+
+			i++;
+		}
+		else if (!std::strcmp(arg, "--density-tolerance"))
+			options.params.densityTolerance = std::atof(value(1)), i++;
+		else if (!std::strcmp(arg, "--max-iterations"))
+			options.params.maxPressureIterations = std::atoi(value(1)), i++;
+		else if (!std::strcmp(arg, "--pbf-iterations"))
+			options.params.pbfIterations = std::atoi(value(1)), i++;
+		else if (!std::strcmp(arg, "--no-gravity"))
+			options.params.gravity = false;
+		else if (!std::strcmp(arg, "--no-collisions"))
+			options.params.collisions = false;
+		else if (!std::strcmp(arg, "--report"))
+			options.reportInterval = std::atoi(value(1)), i++;
+		else if (!std::strcmp(arg, "--output"))
+			options.output = value(1), i++;
+		else if (!std::strcmp(arg, "--solver"))
+			options.solver = value(1), i++;
+		else if (!std::strcmp(arg, "--min-spacing"))
+			options.minSpacing = std::atof(value(1)), i++;
+		else if (!std::strcmp(arg, "--cross-check"))
+			options.crossCheck = value(1), i++;
+		else if (!std::strcmp(arg, "--help")) {
+			PrintUsage();
+			return false;
+		}
+		else
+			throw std::runtime_error(std::string("Unknown option ") + arg + "!");
+	}
+
+	if (options.params.particleCount <= 0 || options.steps < 0 || options.dt <= 0.0 || options.params.boxScale <= 0.0)
+		throw std::runtime_error("Particle count, dt and box scale have to be positive!");
+
+	if (options.params.densityTolerance < 0.0 || options.params.maxPressureIterations <= 0 || options.params.pbfIterations <= 0)
+		throw std::runtime_error("Density tolerance can't be negative and iteration counts have to be positive!");
+
+	if (options.frameTime < 0.0 || options.maxSubsteps <= 0)
+		throw std::runtime_error("Frame time can't be negative and max substeps has to be positive!");
+
+	if (options.solver.empty())
+		options.solver = SolverRegistry::Default();
+
+	if (!SolverRegistry::Find(options.solver))
+		throw std::runtime_error("Unknown solver backend " + options.solver + "!");
+
+	if (!options.crossCheck.empty() && !SolverRegistry::Find(options.crossCheck))
+		throw std::runtime_error("Unknown solver backend " + options.crossCheck + "!");
+
+	return true;
+}
+
+static void WritePositions(const std::string& path, const SolverView& particles) {
+	std::ofstream file(path);
+	if (!file)
+		throw std::runtime_error("Failed to open " + path + "!");
+
+	file.precision(17);
+	file << "id,x,y,z,vx,vy,vz,density\n";
+
+	// In id order, so files of different runs line up
+	for (uint32_t id = 0; id < particles.Size(); id++) {
+		const size_t i = particles.IndexOf(id);
+		file << id << ',' << particles.posX[i] << ',' << particles.posY[i] << ',' << particles.posZ[i]
+			<< ',' << particles.velX[i] << ',' << particles.velY[i] << ',' << particles.velZ[i]
+			<< ',' << particles.density[i] << '\n';
+	}
+}
+
+int main(int argc, char** argv) {
+	RunOptions options;
+
+	try {
+		if (!ParseArgs(argc, argv, options))
+			return 0;
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << "\n";
+		PrintUsage();
+		return 1;
+	}
+
+	// Spawn positions come from rand()
+	std::srand(options.seed);
+
+	std::unique_ptr<Solver> solver = SolverRegistry::Create(options.solver);
+	std::unique_ptr<Solver> checkSolver = options.crossCheck.empty() ? nullptr : SolverRegistry::Create(options.crossCheck);
+	SolverCrossCheck crossCheck;
+
+	// Backends step the models they don't have with the stiffness model, the run would report on the wrong one
+	for (const Solver* backend : { solver.get(), checkSolver.get() }) {
+		if (backend && !backend->Supports(options.params.pressureModel)) {
+			std::cerr << "Backend " << backend->GetName() << " doesn't support the " << PressureModelName(options.params.pressureModel) << " pressure model!\n";
+			return 1;
+		}
+	}
+
+	using Clock = std::chrono::steady_clock;
+	const Clock::time_point start = Clock::now();
+
+	if (checkSolver)
+		crossCheck.Init(*solver, *checkSolver, options.params);
+	else
+		solver->Init(options.params);
+
+	// Thread count and neighbour statistics only exist for the CPU backends
+	CpuSolver* cpuSolver = dynamic_cast<CpuSolver*>(solver.get());
+
+	std::cout << "Solver: " << solver->GetName()
+		<< (checkSolver ? std::string(", cross-checked against ") + checkSolver->GetName() : std::string())
+		<< ", particles: " << options.params.particleCount;
+
+	if (cpuSolver)
+		std::cout << ", threads: " << cpuSolver->GetFluidSolver().GetJobSystem().GetThreadCount();
+
+	std::cout << ", steps: " << options.steps
+		<< ", dt: " << options.dt << "\n";
+
+	auto printDivergence = [&]() {
+		const SolverDivergence& divergence = crossCheck.Compare(*solver, *checkSolver);
+
+		if (divergence.valid)
+			std::cout << "Divergence after step " << divergence.step << ": max " << divergence.maxError << ", rms " << divergence.rmsError << "\n";
+	};
+
+	// Without a frame time every step is one frame of exactly one substep
+	eng::FixedTimestep timestep(options.dt, static_cast<uint32_t>(options.maxSubsteps));
+
+	for (int step = 1; step <= options.steps; step++) {
+		const uint32_t substeps = options.frameTime > 0.0 ? timestep.Advance(options.frameTime) : 1;
+
+		for (uint32_t s = 0; s < substeps; s++) {
+			solver->Step(options.dt);
+
+			if (checkSolver)
+				checkSolver->Step(options.dt);
+		}
+
+		if (options.reportInterval > 0 && step % options.reportInterval == 0) {
+			const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+			std::cout << "Step " << step << " - " << elapsed << " s";
+
+			if (options.params.pressureModel != PressureModel::Stiffness) {
+				const PressureSolveReport pressure = solver->GetPressureReport();
+				std::cout << ", pressure iterations: " << pressure.iterations << ", density error: " << pressure.densityError;
+			}
+
+			std::cout << "\n";
+
+			if (checkSolver)
+				printDivergence();
+		}
+	}
+
+	const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+	std::cout << "Done in " << elapsed << " s, "
+		<< (options.steps ? elapsed * 1000.0 / options.steps : 0.0) << " ms/step";
+
+	if (cpuSolver) {
+		const NeighbourList& neighbours = cpuSolver->GetFluidSolver().GetNeighbours();
+		const double rebuildRatio = neighbours.GetStepCount() ? static_cast<double>(neighbours.GetRebuildCount()) / neighbours.GetStepCount() : 0.0;
+
+		std::cout << ", " << neighbours.GetRebuildCount() << " neighbour list rebuilds (" << rebuildRatio << " per step, last skin " << neighbours.GetSkin() << ")";
+	}
+
+	if (cpuSolver && options.params.pressureModel != PressureModel::Stiffness) {
+		const SolverStats& stats = cpuSolver->GetFluidSolver().GetStats();
+		std::cout << ", " << (stats.steps ? static_cast<double>(stats.pressureIterations) / stats.steps : 0.0) << " pressure iterations/step";
+	}
+
+	std::cout << "\n";
+
+	if (checkSolver)
+		printDivergence();
+
+	if (options.frameTime > 0.0)
+		std::cout << timestep.GetTotalSubsteps() << " substeps over " << options.steps << " frames, "
+			<< timestep.GetDroppedTime() << " s dropped by the substep cap\n";
+
+	const SpacingReport spacing = MeasureSpacing(solver->Positions());
+
+	std::cout << "Spacing: closest pair " << spacing.closestPair << ", mean nearest neighbour " << spacing.meanNearest
+		<< ", " << spacing.coincidentPairs << " pairs closer than " << s_CoincidentDistance << "\n";
+
+	if (!options.output.empty()) {
+		try {
+			WritePositions(options.output, solver->Positions());
+		}
+		catch (const std::exception& e) {
+			std::cerr << e.what() << "\n";
+			return 1;
+		}
+	}
+
+	if (spacing.closestPair < options.minSpacing) {
+		std::cerr << "Particles closer than " << options.minSpacing << "!\n";
+		return 2;
+	}
+
+	return 0;
+}
@@ -27,10 +27,14 @@
 
 // Graphics & Display
 #include "Graphics/Vertex.h"
+#include "Graphics/Instance.h"
 #include "Graphics/Particle.h"
 #include "Graphics/UniformObject.h"
 #include "Display/GDevice.h"
 #include "Display/GBuffer.h"
+#include "Display/GUploader.h"
+#include "Display/GUniformRing.h"
+#include "Display/GPipelineCache.h"
 #include "Display/GModel.h"
 #include "Display/GObject.h"
 #include "Display/GCamera.h"
@@ -62,32 +66,39 @@ namespace Render {
 
 	//
 
-	void App::Run(std::function<void()> start, std::function<void()> update, std::function<std::unordered_map<uint64_t, rnd::ObjectSettings*>()> drawList) {
+	void App::Run(std::function<void()> start, std::function<void()> update, std::function<const rnd::DrawListDelta&()> drawList, std::function<const std::unordered_map<uint64_t, rnd::ParticleBatch*>&()> particleBatches) {
 		Init();
 		InitGUI();
-		MainLoop(start, update, drawList);
+		MainLoop(start, update, drawList, particleBatches);
 		Cleanup();
 	}
 
 	void App::Init() {
+		const auto initStart = std::chrono::high_resolution_clock::now();
+
 		Window* pWindow = new Window{ 1280, 720, "Fluid Sim" };
 		m_Device = new GDevice{ *pWindow };
 		m_Camera = new GCamera{};
 		m_CameraController = new GCameraController(pWindow, m_Camera);
 
+		m_PipelineCache = new GPipelineCache{ *m_Device, s_PipelineCachePath };
+
 		CreateSwapChain();
 		CreateImageViews();
 		CreateRenderPass();
 		CreateDescriptorSetLayout();
+
+		const auto pipelineStart = std::chrono::high_resolution_clock::now();
+
 		CreateGraphicsPipeline();
 
 		CreateComputeDescriptorSetsLayout();
 		CreateComputePipeline();		
 
+		UI::pipelineMs = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - pipelineStart).count();
+
 		CreateDepthRes();
 		CreateFrameBuffers();
-		
-		//CreateStorageBuffers();
 
 		// TEXTURE DISABLE
 		//CreateTextureImage();
@@ -95,21 +106,26 @@ namespace Render {
 		//CreateTextureSampler();
 
 		CreateUniformBuffers();
+		CreateInstanceBuffers();
+		CreateStorageBuffers();
 		CreateCommandBuffers();
 		CreateDescriptorPool();
 		CreateDescriptorSets();
 
-		//CreateComputeDescriptorSets();
-		//CreateComputeCommandBuffers();
+		CreateComputeDescriptorSets();
+		CreateComputeCommandBuffers();
 
 		CreateSyncObjects();
+
+		UI::startupMs = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::high_resolution_clock::now() - initStart).count();
+		UI::bPipelineCacheWarm = m_PipelineCache->IsWarm();
 	}
 
 	void App::InitGUI() {
 		UI::Begin(m_Device, m_Device->GetInstance(), m_RenderPass, m_DescPool, s_MaxFramesInFlight);
 	}
 
-	void App::MainLoop(std::function<void()> start, std::function<void()> update, std::function<std::unordered_map<uint64_t, rnd::ObjectSettings*>()> drawList) {
+	void App::MainLoop(std::function<void()> start, std::function<void()> update, std::function<const rnd::DrawListDelta&()> drawList, std::function<const std::unordered_map<uint64_t, rnd::ParticleBatch*>&()> particleBatches) {
 		static auto startTime = std::chrono::high_resolution_clock::now();
 		while (!m_Device->GetWindow()->ShouldClose()) {
 			auto		currentTime = std::chrono::high_resolution_clock::now();
@@ -133,38 +149,42 @@ namespace Render {
 			
 			update();
 
-			std::unordered_map<uint64_t, rnd::ObjectSettings*> objSett = drawList();
-			
-			
-			std::vector<uint64_t> markIdForDeletion;
-			for (const auto& elem : m_Objects) {
-				bool found = false;
+			m_ParticleBatches = &particleBatches();
+
+			// Only the objects that changed since the last frame are visited
+			const rnd::DrawListDelta& delta = drawList();
+
+			for (uint64_t id : delta.removed) {
+				auto object = m_Objects.find(id);
 
-				if (objSett.find(elem.first) != objSett.end())
-					found = true;
+				if (object == m_Objects.end())
+					continue;
 
-				if (!found)
-					markIdForDeletion.push_back(elem.first);
+				delete object->second;
+				m_Objects.erase(object);
 			}
 
-			for (const auto& elem : markIdForDeletion) {
-				m_Objects.erase(elem);
+			auto applySettings = [](GObject* object, const rnd::ObjectSettings* settings) {
+				object->transform.rotate = settings->transform.rotate;
+				object->transform.translate = settings->transform.translate;
+				object->transform.scale = settings->transform.scale;
+				object->color = settings->color;
+			};
+
+			for (const rnd::ObjectSettings* settings : delta.added) {
+				GObject*& object = m_Objects[settings->id];
+
+				if (!object)
+					object = new GObject{ *m_Device, settings->path, settings->color };
+
+				applySettings(object, settings);
 			}
-			
 
-			for (const auto& elem : objSett) {
-				if (!m_Objects[elem.first]) {
-					m_Objects[elem.first] = new GObject{ *m_Device, elem.second->path, elem.second->color };
-				}
+			for (const rnd::ObjectSettings* settings : delta.updated) {
+				auto object = m_Objects.find(settings->id);
 
-				if (m_Objects[elem.first]->transform.rotate != elem.second->transform.rotate)
-					m_Objects[elem.first]->transform.rotate = elem.second->transform.rotate;
-				if (m_Objects[elem.first]->transform.translate != elem.second->transform.translate)
-					m_Objects[elem.first]->transform.translate = elem.second->transform.translate;
-				if (m_Objects[elem.first]->transform.scale != elem.second->transform.scale)
-					m_Objects[elem.first]->transform.scale = elem.second->transform.scale;
-				if (m_Objects[elem.first]->color != elem.second->color)
-					m_Objects[elem.first]->color = elem.second->color;
+				if (object != m_Objects.end())
+					applySettings(object->second, settings);
 			}
 
 		}
@@ -175,6 +195,18 @@ namespace Render {
 	void App::Cleanup() {
 		UI::End();
 
+		// Pipelines built this run start warm on the next one
+		m_PipelineCache->Save();
+
+		// Models hold ranges of the device's allocator, they go before it in every configuration
+		m_Batches.clear();
+
+		for (auto& elem : m_Objects)
+			delete elem.second;
+		m_Objects.clear();
+
+		GObject::ReleaseModels();
+
 		//
 		// This is added because in the release configuration this results in an exception.
 		// Letting the optimizer deallocate the memory as this is run just before the whole application closes.
@@ -188,10 +220,10 @@ namespace Render {
 		vkDestroyImage(m_Device->GetDevice(), m_TextureImg, nullptr);
 		vkFreeMemory(m_Device->GetDevice(), m_TextureImgMem, nullptr);
 
-		for (size_t i = 0; i < s_MaxFramesInFlight; i++) {
-			vkDestroyBuffer(m_Device->GetDevice(), m_UniformBuffers[i], nullptr);
-			vkFreeMemory(m_Device->GetDevice(), m_UniformBuffersMem[i], nullptr);
-		}
+		delete m_UniformRing;
+
+		for (size_t i = 0; i < s_MaxFramesInFlight; i++)
+			GBuffer::DestroyBuffer(m_Device, m_InstanceBuffers[i], m_InstanceBuffersMem[i]);
 
 		vkDestroyDescriptorSetLayout(m_Device->GetDevice(), m_DescSetLayout, nullptr);
 
@@ -205,6 +237,9 @@ namespace Render {
 			vkDestroySemaphore(m_Device->GetDevice(), m_RenderFinishedSemaphores[i], nullptr);
 			vkDestroySemaphore(m_Device->GetDevice(), m_ImageAvailableSemaphores[i], nullptr);
 			vkDestroyFence(m_Device->GetDevice(), m_IFFences[i], nullptr);
+
+			vkDestroySemaphore(m_Device->GetDevice(), m_ComputeFinishedSemaphores[i], nullptr);
+			vkDestroyFence(m_Device->GetDevice(), m_ComputeIFFences[i], nullptr);
 		}
 
 		vkDestroyCommandPool(m_Device->GetDevice(), m_Device->GetCommandPool(), nullptr);
@@ -212,7 +247,22 @@ namespace Render {
 		for (auto elem : m_Framebuffers)
 			vkDestroyFramebuffer(m_Device->GetDevice(), elem, nullptr);
 
+		for (size_t i = 0; i < s_MaxFramesInFlight; i++)
+			GBuffer::DestroyBuffer(m_Device, m_StorageBuffers[i], m_StorageBuffersMem[i]);
+
+		for (size_t i = 0; i < s_MaxFramesInFlight; i++)
+			GBuffer::DestroyBuffer(m_Device, m_ReadbackBuffers[i], m_ReadbackBuffersMem[i]);
+
+		GBuffer::DestroyBuffer(m_Device, m_ScratchBuffer, m_ScratchBufferMem);
+		GBuffer::DestroyBuffer(m_Device, m_GridBuffer, m_GridBufferMem);
+
+		vkDestroyPipeline(m_Device->GetDevice(), m_ComputePipeline, nullptr);
+		vkDestroyPipelineLayout(m_Device->GetDevice(), m_ComputePipelineLayout, nullptr);
+		vkDestroyDescriptorSetLayout(m_Device->GetDevice(), m_ComputeDescSetLayout, nullptr);
+
+		vkDestroyPipeline(m_Device->GetDevice(), m_ParticlePipeline, nullptr);
 		vkDestroyPipeline(m_Device->GetDevice(), m_GraphicsPipeline, nullptr);
+		delete m_PipelineCache;
 		vkDestroyPipelineLayout(m_Device->GetDevice(), m_PipelineLayout, nullptr);
 		vkDestroyRenderPass(m_Device->GetDevice(), m_RenderPass, nullptr);
 
@@ -374,7 +424,7 @@ namespace Render {
 	void App::CreateDescriptorSetLayout() {
 		VkDescriptorSetLayoutBinding uniBuffLayoutBinding{};
 		uniBuffLayoutBinding.binding = 0;
-		uniBuffLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		uniBuffLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 		uniBuffLayoutBinding.descriptorCount = 1;
 		uniBuffLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
 		uniBuffLayoutBinding.pImmutableSamplers = nullptr;
@@ -414,9 +464,11 @@ namespace Render {
 	void App::CreateGraphicsPipeline() {
 		auto vertShaderCode = Helper::ReadFile("shaders/vert.spv");
 		auto fragShaderCode = Helper::ReadFile("shaders/frag.spv");
+		auto particleShaderCode = Helper::ReadFile("shaders/particle.spv");
 
 		VkShaderModule vertShaderModule = CreateShaderModule(vertShaderCode);
 		VkShaderModule fragShaderModule = CreateShaderModule(fragShaderCode);
+		VkShaderModule particleShaderModule = CreateShaderModule(particleShaderCode);
 		
 		VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
 		vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -435,16 +487,50 @@ namespace Render {
 			, fragShaderStageInfo
 		};
 
-		auto bindingDescr = Vertex::GetBindingDescription();
-		auto attributeDescrs = Vertex::GetAttributeDescriptions();
+		VkPipelineShaderStageCreateInfo particleShaderStageInfo = vertShaderStageInfo;
+		particleShaderStageInfo.module = particleShaderModule;
+
+		std::vector<VkPipelineShaderStageCreateInfo> particleShaderStages {
+			  particleShaderStageInfo
+			, fragShaderStageInfo
+		};
+
+		// Binding 0 is the mesh, binding 1 steps once per instance
+		std::array<VkVertexInputBindingDescription, 2> bindingDescrs = {
+			  Vertex::GetBindingDescription()
+			, Instance::GetBindingDescription()
+		};
+
+		auto vertexAttributeDescrs = Vertex::GetAttributeDescriptions();
+		auto instanceAttributeDescrs = Instance::GetAttributeDescriptions();
+
+		std::vector<VkVertexInputAttributeDescription> attributeDescrs(vertexAttributeDescrs.begin(), vertexAttributeDescrs.end());
+		attributeDescrs.insert(attributeDescrs.end(), instanceAttributeDescrs.begin(), instanceAttributeDescrs.end());
 
 		VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
 		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		vertexInputInfo.vertexBindingDescriptionCount = 1;
+		vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescrs.size());
 		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescrs.size());
-		vertexInputInfo.pVertexBindingDescriptions = &bindingDescr;
+		vertexInputInfo.pVertexBindingDescriptions = bindingDescrs.data();
 		vertexInputInfo.pVertexAttributeDescriptions = attributeDescrs.data();
 
+		// The particle pipeline takes its instances straight from the simulation SSBO
+		std::array<VkVertexInputBindingDescription, 2> particleBindingDescrs = {
+			  Vertex::GetBindingDescription()
+			, Particle::GetBindingDescription()
+		};
+
+		auto particleAttributeDescrs = Particle::GetAttributeDescriptions();
+
+		std::vector<VkVertexInputAttributeDescription> particleAttrDescrs(vertexAttributeDescrs.begin(), vertexAttributeDescrs.end());
+		particleAttrDescrs.insert(particleAttrDescrs.end(), particleAttributeDescrs.begin(), particleAttributeDescrs.end());
+
+		VkPipelineVertexInputStateCreateInfo particleVertexInputInfo = vertexInputInfo;
+		particleVertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(particleBindingDescrs.size());
+		particleVertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(particleAttrDescrs.size());
+		particleVertexInputInfo.pVertexBindingDescriptions = particleBindingDescrs.data();
+		particleVertexInputInfo.pVertexAttributeDescriptions = particleAttrDescrs.data();
+
 		VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo{};
 		inputAssemblyInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
 		inputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
@@ -495,16 +581,16 @@ namespace Render {
 		dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(dStates.size());
 		dynamicStateInfo.pDynamicStates = dStates.data();
 		
+		// Model matrix and color come from the instance buffer, the particle pipeline pushes its scale
 		VkPushConstantRange pushConstantRange{};
-		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 		pushConstantRange.offset = 0;
-		pushConstantRange.size = sizeof(PushConstantData);
+		pushConstantRange.size = sizeof(float);
 
 		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
 		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 		pipelineLayoutInfo.setLayoutCount = 1;
 		pipelineLayoutInfo.pSetLayouts = &m_DescSetLayout;
-		pipelineLayoutInfo.pushConstantRangeCount = 0;
 		pipelineLayoutInfo.pushConstantRangeCount = 1;
 		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
@@ -541,11 +627,23 @@ namespace Render {
 		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 		pipelineInfo.basePipelineIndex = -1;
 
-		if (vkCreateGraphicsPipelines(m_Device->GetDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_GraphicsPipeline) != VK_SUCCESS)
+		// Same state, only the vertex shader and the instance binding differ
+		std::array<VkGraphicsPipelineCreateInfo, 2> pipelineInfos = { pipelineInfo, pipelineInfo };
+		pipelineInfos[1].stageCount = static_cast<uint32_t>(particleShaderStages.size());
+		pipelineInfos[1].pStages = particleShaderStages.data();
+		pipelineInfos[1].pVertexInputState = &particleVertexInputInfo;
+
+		std::array<VkPipeline, 2> pipelines{};
+
+		if (vkCreateGraphicsPipelines(m_Device->GetDevice(), m_PipelineCache->GetVkPipelineCache(), static_cast<uint32_t>(pipelineInfos.size()), pipelineInfos.data(), nullptr, pipelines.data()) != VK_SUCCESS)
 			throw std::runtime_error("Failed to create graphics pipeline!");
 
+		m_GraphicsPipeline = pipelines[0];
+		m_ParticlePipeline = pipelines[1];
+
 		vkDestroyShaderModule(m_Device->GetDevice(), vertShaderModule, nullptr);
 		vkDestroyShaderModule(m_Device->GetDevice(), fragShaderModule, nullptr);
+		vkDestroyShaderModule(m_Device->GetDevice(), particleShaderModule, nullptr);
 	}
 
 	void App::CreateFrameBuffers() {
@@ -626,7 +724,7 @@ namespace Render {
 			throw std::runtime_error("Failed to load texture image!");
 
 		VkBuffer stagingBuffer;
-		VkDeviceMemory stagingBufferMem;
+		GAllocation stagingBufferMem;
 		GBuffer::CreateBuffer(
 			  m_Device
 			, imgSize
@@ -636,10 +734,7 @@ namespace Render {
 			, stagingBufferMem
 		);
 
-		void* data;
-		vkMapMemory(m_Device->GetDevice(), stagingBufferMem, 0, imgSize, 0, &data);
-		memcpy(data, pixels, static_cast<size_t>(imgSize));
-		vkUnmapMemory(m_Device->GetDevice(), stagingBufferMem);
+		memcpy(stagingBufferMem.mapped, pixels, static_cast<size_t>(imgSize));
 
 		stbi_image_free(pixels);
 		CreateImage(
@@ -668,8 +763,7 @@ namespace Render {
 			, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
 		);
 
-		vkDestroyBuffer(m_Device->GetDevice(), stagingBuffer, nullptr);
-		vkFreeMemory(m_Device->GetDevice(), stagingBufferMem, nullptr);
+		GBuffer::DestroyBuffer(m_Device, stagingBuffer, stagingBufferMem);
 	}
 
 	void App::CreateTextureImageView() {
@@ -826,6 +920,15 @@ namespace Render {
 		pipelineLayoutInfo.setLayoutCount = 1;
 		pipelineLayoutInfo.pSetLayouts = &m_ComputeDescSetLayout;
 
+		// The simulation parameters and the pass of the step
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(SimulationConstants);
+
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
 		if (vkCreatePipelineLayout(m_Device->GetDevice(), &pipelineLayoutInfo, nullptr, &m_ComputePipelineLayout) != VK_SUCCESS)
 			throw std::runtime_error("Failed to create compute pipeline layout!");
 
@@ -834,87 +937,150 @@ namespace Render {
 		pipelineInfo.layout = m_ComputePipelineLayout;
 		pipelineInfo.stage  = computeStageInfo;
 
-		if (vkCreateComputePipelines(m_Device->GetDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_ComputePipeline))
+		if (vkCreateComputePipelines(m_Device->GetDevice(), m_PipelineCache->GetVkPipelineCache(), 1, &pipelineInfo, nullptr, &m_ComputePipeline))
 			throw std::runtime_error("Failed to create compute pipeline!");
 
 		vkDestroyShaderModule(m_Device->GetDevice(), computeShaderModule, nullptr);
 	}
 
 	void App::CreateStorageBuffers() {
-		std::default_random_engine rndEngine((unsigned)time(nullptr));
-		std::uniform_real_distribution<float> rndDist(0.0f, 1.0f);
-
-		std::vector<Particle> particles(s_ParticleCount);
-		for (auto& particle : particles) {
-			float r = 0.25f * sqrt(rndDist(rndEngine));
-			float theta = rndDist(rndEngine) * 2.0f * 3.141592f;
-			float x = r * cos(theta);
-			float y = r * sin(theta);
-			float z = 0;
-			particle.pos = glm::vec3(x, y, z);
-			particle.vel = glm::vec3(0.0f, 0.0f, 0.0f);
-			particle.color = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
-		}
-
-		VkDeviceSize bufferSize = sizeof(Particle) * s_ParticleCount;
-		
-		VkBuffer stagingBuffer;
-		VkDeviceMemory stagingBufferMem;
-		GBuffer::CreateBuffer(m_Device, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMem);
-
-		void* data;
-		vkMapMemory(m_Device->GetDevice(), stagingBufferMem, 0, bufferSize, 0, &data);
-		memcpy(data, particles.data(), static_cast<size_t>(bufferSize));
-		vkUnmapMemory(m_Device->GetDevice(), stagingBufferMem);
+		const VkDeviceSize particleBytes = sizeof(Particle) * s_MaxGpuParticles;
 
 		m_StorageBuffers.resize(s_MaxFramesInFlight);
 		m_StorageBuffersMem.resize(s_MaxFramesInFlight);
 
+		// Frame i steps from buffer i - 1 into buffer i and draws buffer i
 		for (size_t i = 0; i < s_MaxFramesInFlight; i++) {
 			GBuffer::CreateBuffer(
 				  m_Device
-				, bufferSize
-				, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+				, particleBytes
+				, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT
 				, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
 				, m_StorageBuffers[i]
 				, m_StorageBuffersMem[i]
+				, true
 			);
+		}
+
+		// Input of every substep after the first one of a frame
+		GBuffer::CreateBuffer(
+			  m_Device
+			, particleBytes
+			, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+			, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+			, m_ScratchBuffer
+			, m_ScratchBufferMem
+			, true
+		);
+
+		// Cells as large as the interaction range, the 27 cells around a particle hold all its pairs.
+		// Allocated for the largest box, the steps only use the cells of the current one.
+		const float cellSize = 2.0f * s_GpuParticleRadius;
+		const glm::ivec3 maxGridDim{ glm::ceil(glm::vec3{ s_GpuBoxSize * GpuSimulationState::s_MaxBoxScale } / cellSize) };
+		m_GpuMaxCellCount = static_cast<uint32_t>(maxGridDim.x * maxGridDim.y * maxGridDim.z);
+
+		VkPhysicalDeviceProperties props{};
+		vkGetPhysicalDeviceProperties(m_Device->GetPhysicalDevice(), &props);
+
+		const VkDeviceSize alignment = props.limits.minStorageBufferOffsetAlignment;
 
-			GBuffer::CopyBuffer(
+		// Cell counts, cell starts, cell and slot of every particle, particles sorted by cell
+		const std::array<VkDeviceSize, 4> rangeSizes = {
+			  sizeof(uint32_t) * m_GpuMaxCellCount
+			, sizeof(uint32_t) * m_GpuMaxCellCount
+			, sizeof(uint32_t) * 2 * s_MaxGpuParticles
+			, sizeof(uint32_t) * s_MaxGpuParticles
+		};
+
+		VkDeviceSize gridBytes = 0;
+
+		for (size_t r = 0; r < rangeSizes.size(); r++) {
+			gridBytes = (gridBytes + alignment - 1) / alignment * alignment;
+			m_GridBufferInfos[r].offset = gridBytes;
+			m_GridBufferInfos[r].range = rangeSizes[r];
+			gridBytes += rangeSizes[r];
+		}
+
+		// Only touched by the compute queue, every step rebuilds it
+		GBuffer::CreateBuffer(
+			  m_Device
+			, gridBytes
+			, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+			, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+			, m_GridBuffer
+			, m_GridBufferMem
+		);
+
+		for (auto& info : m_GridBufferInfos)
+			info.buffer = m_GridBuffer;
+
+		m_ReadbackBuffers.resize(s_MaxFramesInFlight);
+		m_ReadbackBuffersMem.resize(s_MaxFramesInFlight);
+		m_ReadbackPending.assign(s_MaxFramesInFlight, false);
+		m_ReadbackSteps.assign(s_MaxFramesInFlight, 0);
+
+		// Host copies of the particles, only written while GpuSimulationState::bReadback is set
+		for (size_t i = 0; i < s_MaxFramesInFlight; i++) {
+			GBuffer::CreateBuffer(
 				  m_Device
-				, stagingBuffer
-				, m_StorageBuffers[i]
-				, bufferSize
+				, particleBytes
+				, VK_BUFFER_USAGE_TRANSFER_DST_BIT
+				, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+				, m_ReadbackBuffers[i]
+				, m_ReadbackBuffersMem[i]
+				, true
 			);
 		}
+	}
+
+	void App::SeedStorageBuffers() {
+		// Nothing may read the particles while they are replaced
+		vkDeviceWaitIdle(m_Device->GetDevice());
+
+		// The spawn comes from the solver backend, so it matches the CPU solvers it is checked against
+		const std::vector<glm::vec3>& positions = GpuSimulationState::seedPositions;
+		const std::vector<glm::vec3>& velocities = GpuSimulationState::seedVelocities;
+
+		m_GpuParticleCount = static_cast<uint32_t>(std::min<size_t>(positions.size(), s_MaxGpuParticles));
+
+		std::vector<Particle> particles(m_GpuParticleCount);
+		for (uint32_t i = 0; i < m_GpuParticleCount; i++) {
+			particles[i].pos = positions[i];
+			particles[i].vel = velocities[i];
+			particles[i].density = 0.0f;
+			particles[i].pressure = 0.0f;
+			particles[i].color = glm::vec4{ 1.0f };
+		}
+
+		const VkDeviceSize bufferSize = sizeof(Particle) * m_GpuParticleCount;
+
+		// Whichever buffer the first step reads holds the spawn
+		for (size_t i = 0; i < s_MaxFramesInFlight && bufferSize > 0; i++)
+			m_Device->GetUploader().Upload(m_StorageBuffers[i], 0, particles.data(), bufferSize);
+
+		// Uploads go through the graphics queue, nothing orders them before the first compute submit
+		m_Device->GetUploader().WaitIdle();
 
-		vkDestroyBuffer(m_Device->GetDevice(), stagingBuffer, nullptr);
-		vkFreeMemory(m_Device->GetDevice(), stagingBufferMem, nullptr);
+		// Copies taken before the seed belong to the old particles
+		std::fill(m_ReadbackPending.begin(), m_ReadbackPending.end(), false);
+		m_GpuStepsSubmitted = 0;
 	}
 
 	void App::CreateComputeDescriptorSetsLayout() {
-		std::array<VkDescriptorSetLayoutBinding, 3> layoutBindings{};
-		layoutBindings[0].binding = 0;
-		layoutBindings[0].descriptorCount = 1;
-		layoutBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		layoutBindings[0].pImmutableSamplers = nullptr;
-		layoutBindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-
-		layoutBindings[1].binding = 1;
-		layoutBindings[1].descriptorCount = 1;
-		layoutBindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-		layoutBindings[1].pImmutableSamplers = nullptr;
-		layoutBindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-
-		layoutBindings[2].binding = 2;
-		layoutBindings[2].descriptorCount = 1;
-		layoutBindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-		layoutBindings[2].pImmutableSamplers = nullptr;
-		layoutBindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		// Particles in, particles out, cell counts, cell starts, particle cells, sorted indices
+		std::array<VkDescriptorSetLayoutBinding, 6> layoutBindings{};
+
+		for (uint32_t b = 0; b < layoutBindings.size(); b++) {
+			layoutBindings[b].binding = b;
+			layoutBindings[b].descriptorCount = 1;
+			layoutBindings[b].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			layoutBindings[b].pImmutableSamplers = nullptr;
+			layoutBindings[b].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		}
 
 		VkDescriptorSetLayoutCreateInfo layoutInfo{};
 		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-		layoutInfo.bindingCount = 3;
+		layoutInfo.bindingCount = static_cast<uint32_t>(layoutBindings.size());
 		layoutInfo.pBindings = layoutBindings.data();
 
 		if (vkCreateDescriptorSetLayout(m_Device->GetDevice(), &layoutInfo, nullptr, &m_ComputeDescSetLayout) != VK_SUCCESS)
@@ -922,61 +1088,58 @@ namespace Render {
 	}
 
 	void App::CreateComputeDescriptorSets() {
-		std::vector<VkDescriptorSetLayout> layouts(s_MaxFramesInFlight, m_ComputeDescSetLayout);
+		// Per frame the set of its first step and the set of the substeps after it
+		const uint32_t setCount = static_cast<uint32_t>(s_MaxFramesInFlight) * 2;
+
+		std::vector<VkDescriptorSetLayout> layouts(setCount, m_ComputeDescSetLayout);
 		
 		VkDescriptorSetAllocateInfo allocateInfo{};
 		allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
 		allocateInfo.descriptorPool = m_DescPool;
-		allocateInfo.descriptorSetCount = static_cast<uint32_t>(s_MaxFramesInFlight);
+		allocateInfo.descriptorSetCount = setCount;
 		allocateInfo.pSetLayouts = layouts.data();
 
-		m_ComputeDescSets.resize(s_MaxFramesInFlight);
+		m_ComputeDescSets.resize(setCount);
 
 		if (vkAllocateDescriptorSets(m_Device->GetDevice(), &allocateInfo, m_ComputeDescSets.data()) != VK_SUCCESS)
 			throw std::runtime_error("Failed to allocate descriptor sets!");
 
-		for (size_t i = 0; i < s_MaxFramesInFlight; i++) {
-			VkDescriptorBufferInfo uniBuffInfo{};
-			uniBuffInfo.buffer = m_UniformBuffers[i];
-			uniBuffInfo.offset = 0;
-			uniBuffInfo.range = sizeof(UniformBufferObject);
-
-			std::array<VkWriteDescriptorSet, 3> descWrites{};
-			descWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			descWrites[0].dstSet = m_ComputeDescSets[i];
-			descWrites[0].dstBinding = 0;
-			descWrites[0].dstArrayElement = 0;
-			descWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-			descWrites[0].descriptorCount = 1;
-			descWrites[0].pBufferInfo = &uniBuffInfo;
-
-			VkDescriptorBufferInfo storageBuffLF{};
-			storageBuffLF.buffer = m_StorageBuffers[(i - 1) % s_MaxFramesInFlight];
-			storageBuffLF.offset = 0;
-			storageBuffLF.range = sizeof(Particle) * s_ParticleCount;
+		for (uint32_t i = 0; i < setCount; i++) {
+			const uint32_t frame = i / 2;
+			const bool substep = i % 2;
+
+			VkDescriptorBufferInfo particlesIn{};
+			particlesIn.buffer = substep ? m_ScratchBuffer : m_StorageBuffers[(frame + s_MaxFramesInFlight - 1) % s_MaxFramesInFlight];
+			particlesIn.offset = 0;
+			particlesIn.range = sizeof(Particle) * s_MaxGpuParticles;
+
+			VkDescriptorBufferInfo particlesOut{};
+			particlesOut.buffer = m_StorageBuffers[frame];
+			particlesOut.offset = 0;
+			particlesOut.range = sizeof(Particle) * s_MaxGpuParticles;
+
+			const std::array<VkDescriptorBufferInfo, 6> bufferInfos = {
+				  particlesIn
+				, particlesOut
+				, m_GridBufferInfos[0]
+				, m_GridBufferInfos[1]
+				, m_GridBufferInfos[2]
+				, m_GridBufferInfos[3]
+			};
+
+			std::array<VkWriteDescriptorSet, 6> descWrites{};
+
+			for (uint32_t b = 0; b < descWrites.size(); b++) {
+				descWrites[b].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				descWrites[b].dstSet = m_ComputeDescSets[i];
+				descWrites[b].dstBinding = b;
+				descWrites[b].dstArrayElement = 0;
+				descWrites[b].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				descWrites[b].descriptorCount = 1;
+				descWrites[b].pBufferInfo = &bufferInfos[b];
+			}
 
-			descWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			descWrites[1].dstSet = m_ComputeDescSets[i];
-			descWrites[1].dstBinding = 2;
-			descWrites[1].dstArrayElement = 0;
-			descWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-			descWrites[1].descriptorCount = 1;
-			descWrites[1].pBufferInfo = &storageBuffLF;
-
-			VkDescriptorBufferInfo storageBuffCR{};
-			storageBuffCR.buffer = m_StorageBuffers[i];
-			storageBuffCR.offset = 0;
-			storageBuffCR.range = sizeof(Particle) * s_ParticleCount;
-
-			descWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			descWrites[2].dstSet = m_ComputeDescSets[i];
-			descWrites[2].dstBinding = 3;
-			descWrites[2].dstArrayElement = 0;
-			descWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-			descWrites[2].descriptorCount = 1;
-			descWrites[2].pBufferInfo = &storageBuffCR;
-
-			vkUpdateDescriptorSets(m_Device->GetDevice(), 3, descWrites.data(), 0, nullptr);
+			vkUpdateDescriptorSets(m_Device->GetDevice(), static_cast<uint32_t>(descWrites.size()), descWrites.data(), 0, nullptr);
 		}
 	}
 
@@ -985,7 +1148,7 @@ namespace Render {
 		
 		VkCommandBufferAllocateInfo commandBuffAllocInfo{};
 		commandBuffAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		commandBuffAllocInfo.commandPool = m_Device->GetCommandPool();
+		commandBuffAllocInfo.commandPool = m_Device->GetComputeCommandPool();
 		commandBuffAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
 		commandBuffAllocInfo.commandBufferCount = static_cast<uint32_t>(m_ComputeCommandBuffers.size());
 
@@ -994,20 +1157,40 @@ namespace Render {
 	}
 
 	void App::CreateUniformBuffers() {
-		VkDeviceSize bufferSize = sizeof(UniformBufferObject);
-	
-		m_UniformBuffers.resize(s_MaxFramesInFlight);
-		m_UniformBuffersMem.resize(s_MaxFramesInFlight);
+		// Every frame region is mapped for the lifetime of the ring
+		m_UniformRing = new GUniformRing{ *m_Device, s_UniformFrameSize, s_MaxFramesInFlight };
+	}
 
-		for (size_t i = 0; i < s_MaxFramesInFlight; i++)
-			GBuffer::CreateBuffer(
-				  m_Device
-				, bufferSize
-				, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
-				, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-				, m_UniformBuffers[i]
-				, m_UniformBuffersMem[i]
-			);
+	void App::CreateInstanceBuffers() {
+		m_InstanceBuffers.assign(s_MaxFramesInFlight, VK_NULL_HANDLE);
+		m_InstanceBuffersMem.assign(s_MaxFramesInFlight, GAllocation{});
+		m_InstanceBuffersCapacity.assign(s_MaxFramesInFlight, 0);
+
+		for (uint32_t i = 0; i < s_MaxFramesInFlight; i++)
+			ReserveInstanceBuffer(i, s_InitialInstanceCapacity);
+	}
+
+	void App::ReserveInstanceBuffer(uint32_t frame, size_t instanceCount) {
+		if (instanceCount <= m_InstanceBuffersCapacity[frame])
+			return;
+
+		// Only called while recording the frame, after its fence was waited on,
+		// so the GPU is done reading the old buffer
+		if (m_InstanceBuffers[frame] != VK_NULL_HANDLE)
+			GBuffer::DestroyBuffer(m_Device, m_InstanceBuffers[frame], m_InstanceBuffersMem[frame]);
+
+		const size_t capacity = std::max(instanceCount, m_InstanceBuffersCapacity[frame] * 2);
+
+		GBuffer::CreateBuffer(
+			  m_Device
+			, sizeof(Instance) * capacity
+			, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT
+			, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+			, m_InstanceBuffers[frame]
+			, m_InstanceBuffersMem[frame]
+		);
+
+		m_InstanceBuffersCapacity[frame] = capacity;
 	}
 
 	void App::CopyBufferToImg(VkBuffer buffer, VkImage img, uint32_t width, uint32_t height) {
@@ -1036,18 +1219,22 @@ namespace Render {
 	}
 
 	void App::CreateDescriptorPool() {
-		std::array<VkDescriptorPoolSize, 2> descPoolSizes{};
-		descPoolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		std::array<VkDescriptorPoolSize, 3> descPoolSizes{};
+		descPoolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 		descPoolSizes[0].descriptorCount = static_cast<uint32_t>(s_MaxFramesInFlight);
 		descPoolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 		descPoolSizes[1].descriptorCount = static_cast<uint32_t>(s_MaxFramesInFlight) * 2;
 
+		// Two compute sets of six buffers per frame
+		descPoolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		descPoolSizes[2].descriptorCount = static_cast<uint32_t>(s_MaxFramesInFlight) * 2 * 6;
+
 		VkDescriptorPoolCreateInfo descPoolInfo{};
 		descPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
 		descPoolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
 		descPoolInfo.poolSizeCount = static_cast<uint32_t>(descPoolSizes.size());
 		descPoolInfo.pPoolSizes = descPoolSizes.data();
-		descPoolInfo.maxSets = static_cast<uint32_t>(s_MaxFramesInFlight) * 2;
+		descPoolInfo.maxSets = static_cast<uint32_t>(s_MaxFramesInFlight) * 4;
 
 		if (vkCreateDescriptorPool(m_Device->GetDevice(), &descPoolInfo, nullptr, &m_DescPool) != VK_SUCCESS)
 			throw std::runtime_error("Failed to create descriptor pool!");
@@ -1067,8 +1254,9 @@ namespace Render {
 			throw std::runtime_error("Failed to allocate descriptor sets!");
 
 		for (size_t i = 0; i < s_MaxFramesInFlight; i++) {
+			// Offset of the frame is given when the set is bound
 			VkDescriptorBufferInfo descBufferInfo{};
-			descBufferInfo.buffer = m_UniformBuffers[i];
+			descBufferInfo.buffer = m_UniformRing->GetVkBuffer();
 			descBufferInfo.offset = 0;
 			descBufferInfo.range = sizeof(UniformBufferObject);
 
@@ -1084,7 +1272,7 @@ namespace Render {
 			descWrites[0].dstSet = m_DescSets[i];
 			descWrites[0].dstBinding = 0;
 			descWrites[0].dstArrayElement = 0;
-			descWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			descWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 			descWrites[0].descriptorCount = 1;
 			descWrites[0].pBufferInfo = &descBufferInfo;
 
@@ -1096,32 +1284,6 @@ namespace Render {
 			descWrites[1].descriptorCount = 1;
 			descWrites[1].pImageInfo = &imgInfo;
 
-			/*VkDescriptorBufferInfo storageBuffLF{};
-			storageBuffLF.buffer = m_StorageBuffers[(i - 1) % s_MaxFramesInFlight];
-			storageBuffLF.offset = 0;
-			storageBuffLF.range = sizeof(Particle) * s_ParticleCount;
-
-			descWrites[3].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			descWrites[3].dstSet = m_ComputeDescSets[i];
-			descWrites[3].dstBinding = 2;
-			descWrites[3].dstArrayElement = 0;
-			descWrites[3].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-			descWrites[3].descriptorCount = 1;
-			descWrites[3].pBufferInfo = &storageBuffLF;
-
-			VkDescriptorBufferInfo storageBuffCR{};
-			storageBuffCR.buffer = m_StorageBuffers[i];
-			storageBuffCR.offset = 0;
-			storageBuffCR.range = sizeof(Particle) * s_ParticleCount;
-
-			descWrites[4].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			descWrites[4].dstSet = m_ComputeDescSets[i];
-			descWrites[4].dstBinding = 3;
-			descWrites[4].dstArrayElement = 0;
-			descWrites[4].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-			descWrites[4].descriptorCount = 1;
-			descWrites[4].pBufferInfo = &storageBuffCR;*/
-
 			vkUpdateDescriptorSets(m_Device->GetDevice(), static_cast<uint32_t>(descWrites.size()), descWrites.data(), 0, nullptr);
 		}
 	}
@@ -1209,10 +1371,6 @@ namespace Render {
 
 		vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
-		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicsPipeline);
-		
-		DrawObjects(commandBuffer, m_PipelineLayout, m_DescSets[m_CurrentFrame]);
-
 		VkViewport viewPort{};
 		viewPort.x = 0.0f;
 		viewPort.y = 0.0f;
@@ -1229,7 +1387,11 @@ namespace Render {
 
 		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-		vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+		// Viewport and scissor are dynamic, they have to be set before the first draw
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicsPipeline);
+
+		DrawObjects(commandBuffer, m_PipelineLayout, m_DescSets[m_CurrentFrame]);
+		DrawGpuParticles(commandBuffer);
 		
 		UI::Main(commandBuffer);
 		
@@ -1243,39 +1405,160 @@ namespace Render {
 	void App::RecComputeCommandBuffer(VkCommandBuffer commandBuffer) {
 		VkCommandBufferBeginInfo beginInfo{};
 		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
 		if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
 			throw std::runtime_error("Failed to begin recording compute command buffer!");
 
+		auto memoryBarrier = [&](VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess) {
+			VkMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			barrier.srcAccessMask = srcAccess;
+			barrier.dstAccessMask = dstAccess;
+
+			vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+		};
+
+		const VkAccessFlags shaderAccess = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+		// The previous submission wrote the particles this one starts from and used the same grid
+		memoryBarrier(
+			  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT
+			, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, shaderAccess | VK_ACCESS_TRANSFER_READ_BIT);
+
+		VkBuffer current = m_StorageBuffers[m_CurrentFrame];
+		VkBuffer previous = m_StorageBuffers[(m_CurrentFrame + s_MaxFramesInFlight - 1) % s_MaxFramesInFlight];
+
+		VkBufferCopy copyRegion{};
+		copyRegion.size = sizeof(Particle) * m_GpuParticleCount;
+
+		// No step is due, the frame still draws its own buffer
+		if (m_GpuSteps == 0)
+			vkCmdCopyBuffer(commandBuffer, previous, current, 1, &copyRegion);
+
+		SimulationConstants constants = m_GpuConstants;
+
+		const uint32_t particleGroups = (m_GpuParticleCount + s_ComputeGroupSize - 1) / s_ComputeGroupSize;
+		const uint32_t cellGroups = (m_GpuCellCount + s_ComputeGroupSize - 1) / s_ComputeGroupSize;
+
+		// Clear cells, count cells, scan cells (one group), scatter, density, forces and integration
+		const std::array<uint32_t, 6> passGroups = { cellGroups, particleGroups, 1, particleGroups, particleGroups, particleGroups };
+
 		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_ComputePipeline);
-		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_ComputePipelineLayout, 0, 1, &m_ComputeDescSets[m_CurrentFrame], 0, nullptr);
-		vkCmdDispatch(commandBuffer, s_ParticleCount / 256, 1, 1);
+
+		for (uint32_t step = 0; step < m_GpuSteps; step++) {
+			// In and out can't be the same buffer, later substeps start from a copy of the step before
+			if (step > 0) {
+				memoryBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT);
+				vkCmdCopyBuffer(commandBuffer, current, m_ScratchBuffer, 1, &copyRegion);
+				memoryBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, shaderAccess);
+			}
+
+			VkDescriptorSet& descSet = m_ComputeDescSets[m_CurrentFrame * 2 + (step > 0 ? 1 : 0)];
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_ComputePipelineLayout, 0, 1, &descSet, 0, nullptr);
+
+			for (uint32_t pass = 0; pass < passGroups.size(); pass++) {
+				constants.passIndex = pass;
+				vkCmdPushConstants(commandBuffer, m_ComputePipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+				vkCmdDispatch(commandBuffer, passGroups[pass], 1, 1);
+
+				memoryBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, shaderAccess);
+			}
+		}
+
+		// Read by the host once the fence of this frame is waited on again
+		if (GpuSimulationState::bReadback) {
+			memoryBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+			vkCmdCopyBuffer(commandBuffer, current, m_ReadbackBuffers[m_CurrentFrame], 1, &copyRegion);
+			memoryBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT);
+
+			m_ReadbackPending[m_CurrentFrame] = true;
+			m_ReadbackSteps[m_CurrentFrame] = m_GpuStepsSubmitted;
+		}
 
 		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
 			throw std::runtime_error("Failed to record compute command buffer!");
+	}
+
+	void App::UpdateGpuSimulation() {
+		if (GpuSimulationState::bActive && GpuSimulationState::bSeedPending) {
+			SeedStorageBuffers();
+			GpuSimulationState::bSeedPending = false;
+		}
 
+		// Buffer copies can't be empty, there is nothing to step or draw anyway
+		m_bGpuSimulation = GpuSimulationState::bActive && m_GpuParticleCount > 0;
+
+		if (!m_bGpuSimulation)
+			return;
+
+		// The backend runs the fixed timestep, every step it asked for since the last frame is recorded now
+		m_GpuSteps = GpuSimulationState::pendingSteps;
+		GpuSimulationState::pendingSteps = 0;
+
+		m_GpuStepsSubmitted += m_GpuSteps;
+		GpuSimulationState::stepsSubmitted = m_GpuStepsSubmitted;
+
+		const GpuSimulationParams& params = GpuSimulationState::params;
+
+		const float boxSize = s_GpuBoxSize * std::clamp(params.boxScale, 1.0f, GpuSimulationState::s_MaxBoxScale);
+		const float cellSize = 2.0f * s_GpuParticleRadius;
+
+		m_GpuGridDim = glm::ivec3{ glm::ceil(glm::vec3{ boxSize } / cellSize) };
+		m_GpuCellCount = static_cast<uint32_t>(m_GpuGridDim.x * m_GpuGridDim.y * m_GpuGridDim.z);
+
+		m_GpuConstants.particleCount = m_GpuParticleCount;
+		m_GpuConstants.cellCount = m_GpuCellCount;
+		m_GpuConstants.collisions = params.collisions ? 1 : 0;
+		m_GpuConstants.gridDim = m_GpuGridDim;
+		m_GpuConstants.cellSize = cellSize;
+		m_GpuConstants.boxSize = glm::vec3{ boxSize };
+		m_GpuConstants.dt = GpuSimulationState::stepSize;
+		m_GpuConstants.radius = s_GpuParticleRadius;
+		m_GpuConstants.restDensity = params.restDensity;
+		m_GpuConstants.viscosity = params.viscosity;
+		m_GpuConstants.stiffness = params.stiffness;
+		m_GpuConstants.damping = params.damping;
+		m_GpuConstants.gravity = params.gravity;
+		m_GpuConstants.mass = params.mass;
 	}
 
-	void App::DrawFrame() {
-		VkSubmitInfo submitInfo{};
-		/*submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	void App::CollectReadback() {
+		if (!m_ReadbackPending[m_CurrentFrame])
+			return;
 
-		vkWaitForFences(m_Device->GetDevice(), 1, &m_ComputeIFFences[m_CurrentFrame], VK_TRUE, UINT64_MAX);
+		m_ReadbackPending[m_CurrentFrame] = false;
 
-		UpdateUniformBuffer(m_CurrentFrame);
+		// The fence of the frame was waited on, the copy is complete and visible to the host
+		const Particle* particles = static_cast<const Particle*>(m_ReadbackBuffersMem[m_CurrentFrame].mapped);
+
+		GpuSimulationState::readback.assign(particles, particles + m_GpuParticleCount);
+		GpuSimulationState::readbackStep = m_ReadbackSteps[m_CurrentFrame];
+		GpuSimulationState::bReadbackReady = true;
+	}
 
+	void App::SubmitCompute() {
+		vkWaitForFences(m_Device->GetDevice(), 1, &m_ComputeIFFences[m_CurrentFrame], VK_TRUE, UINT64_MAX);
 		vkResetFences(m_Device->GetDevice(), 1, &m_ComputeIFFences[m_CurrentFrame]);
 
+		CollectReadback();
+
 		vkResetCommandBuffer(m_ComputeCommandBuffers[m_CurrentFrame], 0);
 		RecComputeCommandBuffer(m_ComputeCommandBuffers[m_CurrentFrame]);
 
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 		submitInfo.commandBufferCount = 1;
 		submitInfo.pCommandBuffers = &m_ComputeCommandBuffers[m_CurrentFrame];
 		submitInfo.signalSemaphoreCount = 1;
 		submitInfo.pSignalSemaphores = &m_ComputeFinishedSemaphores[m_CurrentFrame];
 
-		if (vkQueueSubmit(m_Device->GetComputeQueue(), 1, &submitInfo, nullptr) != VK_SUCCESS)
-			throw std::runtime_error("Failed to submit compute command buffer!");*/
+		if (vkQueueSubmit(m_Device->GetComputeQueue(), 1, &submitInfo, m_ComputeIFFences[m_CurrentFrame]) != VK_SUCCESS)
+			throw std::runtime_error("Failed to submit compute command buffer!");
+	}
+
+	void App::DrawFrame() {
+		VkSubmitInfo submitInfo{};
 
 		vkWaitForFences(m_Device->GetDevice(), 1, &m_IFFences[m_CurrentFrame], VK_TRUE, UINT64_MAX);
 
@@ -1290,18 +1573,30 @@ namespace Render {
 			throw::std::runtime_error("Failed to acquire swap chain image");
 
 		UpdateUniformBuffer(m_CurrentFrame);
+
+		UpdateGpuSimulation();
+
+		// The simulation step of this frame runs on the compute queue while the
+		// previous frame is still being drawn, only this frame's draws wait for it
+		const bool computeEnabled = m_bGpuSimulation;
+		if (computeEnabled)
+			SubmitCompute();
+
 		RecCommandBuffer(m_CommandBuffers[m_CurrentFrame], imgInd);
 
+		// Uploads queued since the last frame are submitted ahead of the draws that read them
+		m_Device->GetUploader().Flush();
+
 		vkResetFences(m_Device->GetDevice(), 1, &m_IFFences[m_CurrentFrame]);
 		//vkResetCommandBuffer(m_CommandBuffers[m_CurrentFrame], 0);
 
-		VkSemaphore waitSemaphores[] = { m_ImageAvailableSemaphores[m_CurrentFrame] };
+		VkSemaphore waitSemaphores[] = { m_ImageAvailableSemaphores[m_CurrentFrame], computeEnabled ? m_ComputeFinishedSemaphores[m_CurrentFrame] : VK_NULL_HANDLE };
 		VkSemaphore signalSemaphores[] = { m_RenderFinishedSemaphores[m_CurrentFrame] };
-		VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+		VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT };
 		
 		submitInfo = {};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		submitInfo.waitSemaphoreCount = 1;
+		submitInfo.waitSemaphoreCount = computeEnabled ? 2 : 1;
 		submitInfo.pWaitSemaphores = waitSemaphores;
 		submitInfo.pWaitDstStageMask = waitStages;
 		submitInfo.commandBufferCount = 1;
@@ -1349,10 +1644,9 @@ namespace Render {
 		// DeltaTime
 		uniBuff.deltaTime = rnd::Time::DeltaTime();
 
-		void* data;
-		vkMapMemory(m_Device->GetDevice(), m_UniformBuffersMem[currentFrame], 0, sizeof(uniBuff), 0, &data);
-		memcpy(data, &uniBuff, sizeof(uniBuff));
-		vkUnmapMemory(m_Device->GetDevice(), m_UniformBuffersMem[currentFrame]);
+		// The region of this frame is free again once its fence has signaled
+		m_UniformRing->BeginFrame(currentFrame);
+		m_FrameUniformOffset = m_UniformRing->Push(uniBuff);
 	}
 
 	[[nodiscard]] VkShaderModule App::CreateShaderModule(const std::vector<char>& code) {
@@ -1409,30 +1703,93 @@ namespace Render {
 	}
 
 	void App::DrawObjects(VkCommandBuffer& commBuffer, VkPipelineLayout& pipelineLayout, VkDescriptorSet& descSet) {
-		
-		PushConstantData push{};
+		UI::vertexInvocationsBefore = 0;
+		UI::vertexInvocationsAfter = 0;
+
+		vkCmdBindDescriptorSets(commBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descSet, 1, &m_FrameUniformOffset);
 
-		vkCmdBindDescriptorSets(commBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descSet, 0, nullptr);
+		// Objects sharing a model become the instances of one draw
+		for (auto& batch : m_Batches)
+			batch.second.clear();
 
+		size_t instanceCount = 0;
 		for (auto& elem : m_Objects) {
 			if (!elem.second)
 				continue;
 
-			push.modelMatrix = elem.second->transform.Model();
-			push.normalMatrix = elem.second->transform.Normal();
-			push.color = elem.second->color;
-
-			vkCmdPushConstants(
-				  commBuffer
-				, pipelineLayout
-				, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT
-				, 0
-				, sizeof(PushConstantData)
-				, &push
-			);
+			m_Batches[elem.second->GetModelPtr().get()].push_back(Instance{ elem.second->transform.Model(), elem.second->color });
+			instanceCount++;
+		}
+
+		if (m_ParticleBatches) {
+			for (const auto& elem : *m_ParticleBatches) {
+				const rnd::ParticleBatch& particles = *elem.second;
 
-			elem.second->GetModelPtr()->Bind(commBuffer);
-			elem.second->GetModelPtr()->Draw(commBuffer);
+				if (particles.positions.empty())
+					continue;
+
+				std::vector<Instance>& batch = m_Batches[GObject::GetModel(*m_Device, particles.path).get()];
+
+				// Particles are only scaled and translated
+				Instance instance{ glm::mat4{ particles.scale }, glm::vec4{ 1.0f } };
+
+				for (size_t i = 0; i < particles.positions.size(); i++) {
+					instance.model[3] = glm::vec4{ particles.positions[i], 1.0f };
+					instance.color = particles.colors[i];
+					batch.push_back(instance);
+				}
+
+				instanceCount += particles.positions.size();
+			}
+		}
+
+		if (!instanceCount)
+			return;
+
+		ReserveInstanceBuffer(m_CurrentFrame, instanceCount);
+
+		Instance* instances = static_cast<Instance*>(m_InstanceBuffersMem[m_CurrentFrame].mapped);
+
+		VkDeviceSize offsets[] = { 0 };
+		vkCmdBindVertexBuffers(commBuffer, 1, 1, &m_InstanceBuffers[m_CurrentFrame], offsets);
+
+		// Batches go into the buffer back to back, firstInstance points each draw at its own range
+		uint32_t firstInstance = 0;
+		for (auto& batch : m_Batches) {
+			if (batch.second.empty())
+				continue;
+
+			const uint32_t batchCount = static_cast<uint32_t>(batch.second.size());
+			memcpy(instances + firstInstance, batch.second.data(), sizeof(Instance) * batchCount);
+
+			batch.first->Bind(commBuffer);
+			batch.first->Draw(commBuffer, batchCount, firstInstance);
+
+			UI::vertexInvocationsBefore += static_cast<uint64_t>(batch.first->GetStats().transformsBefore) * batchCount;
+			UI::vertexInvocationsAfter += static_cast<uint64_t>(batch.first->GetStats().transformsAfter) * batchCount;
+
+			firstInstance += batchCount;
 		}
 	}
+
+	void App::DrawGpuParticles(VkCommandBuffer& commBuffer) {
+		if (!m_bGpuSimulation)
+			return;
+
+		GModel* model = GObject::GetModel(*m_Device, s_GpuParticleModel).get();
+
+		vkCmdBindPipeline(commBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_ParticlePipeline);
+		vkCmdBindDescriptorSets(commBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout, 0, 1, &m_DescSets[m_CurrentFrame], 1, &m_FrameUniformOffset);
+		vkCmdPushConstants(commBuffer, m_PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(float), &s_GpuParticleScale);
+
+		// The instances are the particles this frame's compute submission wrote, no CPU copy
+		VkDeviceSize offsets[] = { 0 };
+		vkCmdBindVertexBuffers(commBuffer, 1, 1, &m_StorageBuffers[m_CurrentFrame], offsets);
+
+		model->Bind(commBuffer);
+		model->Draw(commBuffer, m_GpuParticleCount, 0);
+
+		UI::vertexInvocationsBefore += static_cast<uint64_t>(model->GetStats().transformsBefore) * m_GpuParticleCount;
+		UI::vertexInvocationsAfter += static_cast<uint64_t>(model->GetStats().transformsAfter) * m_GpuParticleCount;
+	}
 }
\ No newline at end of file
@@ -3,17 +3,27 @@
 // Core
 #include <Defs.h>
 #include <Core/Graphics/Vertex.h>
+#include <Core/Graphics/Instance.h>
+#include <Core/Graphics/GpuSimulationState.h>
+#include <Core/Display/GAllocator.h>
 //
 
 // Front core
+#include <Rnd/DrawList.h>
 #include <Rnd/ObjectSettings.h>
+#include <Rnd/ParticleBatch.h>
 //
 
 // Vulkan
 #include <vulkan/vulkan_core.h>
 //
 
+// GLM
+#include <glm/glm.hpp>
+//
+
 // STL
+#include <array>
 #include <vector>
 #include <functional>
 #include <unordered_map>
@@ -26,6 +36,8 @@ namespace Render {
 	class Window;
 	class GDevice;
 	class GModel;
+	class GUniformRing;
+	class GPipelineCache;
   
 	class GObject;
 	class GCamera;
@@ -36,12 +48,12 @@ namespace Render {
 
 	class App final {
 	public:
-		void Run(std::function<void()> start, std::function<void()> update, std::function<std::unordered_map<uint64_t, rnd::ObjectSettings*>()> drawList);
+		void Run(std::function<void()> start, std::function<void()> update, std::function<const rnd::DrawListDelta&()> drawList, std::function<const std::unordered_map<uint64_t, rnd::ParticleBatch*>&()> particleBatches);
 
 	private:
 		void Init();
 		void InitGUI();
-		void MainLoop(std::function<void()> start, std::function<void()> update, std::function<std::unordered_map<uint64_t, rnd::ObjectSettings*>()> drawList);
+		void MainLoop(std::function<void()> start, std::function<void()> update, std::function<const rnd::DrawListDelta&()> drawList, std::function<const std::unordered_map<uint64_t, rnd::ParticleBatch*>&()> particleBatches);
 		void Cleanup();
 
 		void CreateSwapChain();
@@ -83,6 +95,14 @@ namespace Render {
 
 		void CreateComputeCommandBuffers();
 
+		// Uploads the spawn of GpuSimulationState into both storage buffers, waits for the device first
+		void SeedStorageBuffers();
+
+		void CreateInstanceBuffers();
+
+		// Grows the instance buffer of the frame to hold at least instanceCount instances
+		void ReserveInstanceBuffer(uint32_t frame, size_t instanceCount);
+
 		void CreateImage(
 			  uint32_t width
 			, uint32_t height
@@ -118,6 +138,15 @@ namespace Render {
 
 		void RecComputeCommandBuffer(VkCommandBuffer commandBuffer);
 
+		// Records and submits this frame's compute to the device's compute queue, signals m_ComputeFinishedSemaphores
+		void SubmitCompute();
+
+		// Steps queued through rnd::GpuSimulation and the push constants of the compute passes
+		void UpdateGpuSimulation();
+
+		// Hands the particles the frame copied back last time to GpuSimulationState, after its compute fence
+		void CollectReadback();
+
 
 		void DrawFrame();
 		void UpdateUniformBuffer(uint32_t currentFrame);
@@ -132,10 +161,22 @@ namespace Render {
 
 		// Draw
 		void DrawObjects(VkCommandBuffer& commBuffer, VkPipelineLayout& pipelineLayout, VkDescriptorSet& descSet);
+		void DrawGpuParticles(VkCommandBuffer& commBuffer);
 
 	private_var:
 		static const uint8_t s_MaxFramesInFlight = 2;
 		static const bool s_VSync = false;
+		static const size_t s_InitialInstanceCapacity = 1024;
+		static const VkDeviceSize s_UniformFrameSize = 64 * 1024;
+		static constexpr const char* s_PipelineCachePath = "pipeline.cache";
+
+		// GPU simulation, the box and particles match FluidSolver. The box grows with GpuSimulationParams::boxScale.
+		static const uint32_t s_MaxGpuParticles = GpuSimulationState::s_MaxParticles;
+		static const uint32_t s_ComputeGroupSize = 256;
+		static constexpr float s_GpuParticleRadius = 1.0f;
+		static constexpr float s_GpuBoxSize = 20.0f;
+		static constexpr float s_GpuParticleScale = 0.2f;
+		static constexpr const char* s_GpuParticleModel = "models/lpsphere.obj";
 
 		static VkClearColorValue s_BgColor;
 
@@ -160,6 +201,12 @@ namespace Render {
 		VkPipelineLayout m_PipelineLayout;
 		VkPipeline m_GraphicsPipeline;
 
+		// Instanced straight from the particle storage buffers
+		VkPipeline m_ParticlePipeline;
+
+		// Loaded in Init, saved in Cleanup
+		GPipelineCache* m_PipelineCache = nullptr;
+
 		VkDescriptorSetLayout m_DescSetLayout;
 		VkDescriptorPool m_DescPool;
 
@@ -184,8 +231,9 @@ namespace Render {
 		VkDeviceMemory m_DepthImgMem;
 		VkImageView m_DepthImgView;
 
-		std::vector<VkBuffer> m_UniformBuffers;
-		std::vector<VkDeviceMemory> m_UniformBuffersMem;
+		// Frame uniforms, bound with the dynamic offset of the last push
+		GUniformRing* m_UniformRing = nullptr;
+		uint32_t m_FrameUniformOffset = 0;
 
 		std::vector<VkCommandBuffer> m_CommandBuffers;
 
@@ -200,7 +248,35 @@ namespace Render {
 		VkDeviceMemory m_IndexBufferMem;
 
 		std::vector<VkBuffer> m_StorageBuffers;
-		std::vector<VkDeviceMemory> m_StorageBuffersMem;
+		std::vector<GAllocation> m_StorageBuffersMem;
+
+		// Input of the substeps after the first one
+		VkBuffer m_ScratchBuffer;
+		GAllocation m_ScratchBufferMem{};
+
+		// Cell counts, cell starts, particle cells and sorted indices, one range each
+		VkBuffer m_GridBuffer;
+		GAllocation m_GridBufferMem{};
+		std::array<VkDescriptorBufferInfo, 4> m_GridBufferInfos{};
+
+		// Grid of the current box, the buffer holds the cells of the largest one
+		glm::ivec3 m_GpuGridDim{};
+		uint32_t m_GpuCellCount = 0;
+		uint32_t m_GpuMaxCellCount = 0;
+		uint32_t m_GpuParticleCount = 0;
+
+		// Steps recorded into this frame's compute command buffer and since the last seed
+		uint32_t m_GpuSteps = 0;
+		uint64_t m_GpuStepsSubmitted = 0;
+
+		// Host visible copies of the particles, pending until the frame's compute fence is waited on
+		std::vector<VkBuffer> m_ReadbackBuffers;
+		std::vector<GAllocation> m_ReadbackBuffersMem;
+		std::vector<bool> m_ReadbackPending;
+		std::vector<uint64_t> m_ReadbackSteps;
+
+		bool m_bGpuSimulation = false;
+		SimulationConstants m_GpuConstants{};
 
 		std::vector<Vertex> m_Vertices;
 		std::vector<uint32_t> m_Indices;
@@ -208,9 +284,16 @@ namespace Render {
 		// Draw & Models
 		std::unordered_map<uint64_t, GObject*> m_Objects;
 
+		// Particle systems of the renderer, drawn next to the objects
+		const std::unordered_map<uint64_t, rnd::ParticleBatch*>* m_ParticleBatches = nullptr;
+
+		// Instances of every model, refilled each time a frame is recorded
+		std::unordered_map<GModel*, std::vector<Instance>> m_Batches;
 
-		// TEMP
-		uint32_t s_ParticleCount = 1000;
+		// Per frame instance buffers, host visible and written through GAllocation::mapped
+		std::vector<VkBuffer> m_InstanceBuffers;
+		std::vector<GAllocation> m_InstanceBuffersMem;
+		std::vector<size_t> m_InstanceBuffersCapacity;
 	};
 
 }
\ No newline at end of file
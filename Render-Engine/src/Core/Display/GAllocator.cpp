@@ -0,0 +1,212 @@
+#include "pch.h"
+#include "GAllocator.h"
+#include "GDevice.h"
+
+// Vulkan
+#include <vulkan/vulkan.h>
+//
+
+// STL
+#include <algorithm>
+#include <iterator>
+//
+
+namespace Render {
+
+	GAllocator::GAllocator(GDevice& device) {
+		m_Device = &device;
+
+		vkGetPhysicalDeviceMemoryProperties(m_Device->GetPhysicalDevice(), &m_MemProps);
+		m_Pools.resize(m_MemProps.memoryTypeCount);
+	}
+
+	GAllocator::~GAllocator() {
+		for (auto& pool : m_Pools)
+			for (auto& block : pool.blocks)
+				DestroyBlock(block);
+	}
+
+	[[nodiscard]] GAllocation GAllocator::Allocate(const VkMemoryRequirements& memReq, VkMemoryPropertyFlags props) {
+		GAllocation allocation{};
+		allocation.memType = m_Device->GetMemType(memReq.memoryTypeBits, props);
+		allocation.size = memReq.size;
+
+		Pool& pool = m_Pools[allocation.memType];
+
+		VkDeviceSize offset = 0;
+		uint32_t blockInd = UINT32_MAX;
+
+		// First fit over the blocks already taken from the driver
+		for (uint32_t i = 0; i < pool.blocks.size(); i++) {
+			if (pool.blocks[i].memory != VK_NULL_HANDLE && AllocateFromBlock(pool.blocks[i], memReq.size, memReq.alignment, offset)) {
+				blockInd = i;
+				break;
+			}
+		}
+
+		if (blockInd == UINT32_MAX) {
+			// Requests bigger than a block get a block of their own
+			blockInd = CreateBlock(allocation.memType, std::max(s_BlockSize, memReq.size));
+
+			if (!AllocateFromBlock(pool.blocks[blockInd], memReq.size, memReq.alignment, offset))
+				throw std::runtime_error("Failed to sub-allocate GPU memory!");
+		}
+
+		Block& block = pool.blocks[blockInd];
+		block.liveBytes += memReq.size;
+		block.allocationCount++;
+
+		allocation.memory = block.memory;
+		allocation.offset = offset;
+		allocation.block = blockInd;
+		allocation.mapped = block.mapped ? static_cast<char*>(block.mapped) + offset : nullptr;
+
+		return allocation;
+	}
+
+	void GAllocator::Free(GAllocation& allocation) {
+		if (allocation.memory == VK_NULL_HANDLE)
+			return;
+
+		Block& block = m_Pools[allocation.memType].blocks[allocation.block];
+
+		VkDeviceSize offset = allocation.offset;
+		VkDeviceSize size = allocation.size;
+
+		// Merge with the free range right behind
+		auto next = block.freeRanges.lower_bound(offset);
+		if (next != block.freeRanges.end() && offset + size == next->first) {
+			size += next->second;
+			next = block.freeRanges.erase(next);
+		}
+
+		// and with the one right in front
+		bool merged = false;
+		if (next != block.freeRanges.begin()) {
+			auto prev = std::prev(next);
+
+			if (prev->first + prev->second == offset) {
+				prev->second += size;
+				merged = true;
+			}
+		}
+
+		if (!merged)
+			block.freeRanges[offset] = size;
+
+		block.liveBytes -= allocation.size;
+		block.allocationCount--;
+
+		// The first block of a type is kept, later ones go back to the driver once empty
+		if (block.allocationCount == 0 && allocation.block != 0)
+			DestroyBlock(block);
+
+		allocation = GAllocation{};
+	}
+
+	std::vector<GMemoryStats> GAllocator::GetStats() const {
+		std::vector<GMemoryStats> stats;
+
+		for (uint32_t type = 0; type < m_Pools.size(); type++) {
+			GMemoryStats typeStats{};
+			typeStats.memType = type;
+			typeStats.flags = m_MemProps.memoryTypes[type].propertyFlags;
+
+			for (const auto& block : m_Pools[type].blocks) {
+				if (block.memory == VK_NULL_HANDLE)
+					continue;
+
+				typeStats.liveBytes += block.liveBytes;
+				typeStats.blockBytes += block.size;
+				typeStats.allocationCount += block.allocationCount;
+				typeStats.blockCount++;
+			}
+
+			if (typeStats.blockCount)
+				stats.push_back(typeStats);
+		}
+
+		return stats;
+	}
+
+	VkDeviceSize GAllocator::GetLiveBytes(uint32_t memType) const {
+		VkDeviceSize liveBytes = 0;
+
+		for (const auto& block : m_Pools[memType].blocks)
+			liveBytes += block.liveBytes;
+
+		return liveBytes;
+	}
+
+	bool GAllocator::AllocateFromBlock(Block& block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset) {
+		alignment = std::max<VkDeviceSize>(alignment, 1);
+
+		for (auto range = block.freeRanges.begin(); range != block.freeRanges.end(); range++) {
+			const VkDeviceSize rangeOffset = range->first;
+			const VkDeviceSize rangeSize = range->second;
+
+			const VkDeviceSize alignedOffset = (rangeOffset + alignment - 1) / alignment * alignment;
+			const VkDeviceSize padding = alignedOffset - rangeOffset;
+
+			if (rangeSize < padding + size)
+				continue;
+
+			block.freeRanges.erase(range);
+
+			// The alignment padding in front and the rest behind stay free
+			if (padding)
+				block.freeRanges[rangeOffset] = padding;
+
+			if (rangeSize > padding + size)
+				block.freeRanges[alignedOffset + size] = rangeSize - padding - size;
+
+			offset = alignedOffset;
+			return true;
+		}
+
+		return false;
+	}
+
+	uint32_t GAllocator::CreateBlock(uint32_t memType, VkDeviceSize size) {
+		Pool& pool = m_Pools[memType];
+
+		uint32_t blockInd = 0;
+		while (blockInd < pool.blocks.size() && pool.blocks[blockInd].memory != VK_NULL_HANDLE)
+			blockInd++;
+
+		if (blockInd == pool.blocks.size())
+			pool.blocks.emplace_back();
+
+		Block& block = pool.blocks[blockInd];
+
+		VkMemoryAllocateInfo mallocInfo{};
+		mallocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		mallocInfo.allocationSize = size;
+		mallocInfo.memoryTypeIndex = memType;
+
+		if (vkAllocateMemory(m_Device->GetDevice(), &mallocInfo, nullptr, &block.memory) != VK_SUCCESS)
+			throw std::runtime_error("Failed to allocate GPU memory block!");
+
+		if (m_MemProps.memoryTypes[memType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+			if (vkMapMemory(m_Device->GetDevice(), block.memory, 0, VK_WHOLE_SIZE, 0, &block.mapped) != VK_SUCCESS)
+				throw std::runtime_error("Failed to map GPU memory block!");
+
+		block.size = size;
+		block.freeRanges[0] = size;
+
+		return blockInd;
+	}
+
+	void GAllocator::DestroyBlock(Block& block) {
+		if (block.memory == VK_NULL_HANDLE)
+			return;
+
+		if (block.mapped)
+			vkUnmapMemory(m_Device->GetDevice(), block.memory);
+
+		vkFreeMemory(m_Device->GetDevice(), block.memory, nullptr);
+
+		block = Block{};
+	}
+
+}
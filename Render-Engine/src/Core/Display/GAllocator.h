@@ -0,0 +1,119 @@
+#pragma once
+
+// Vulkan
+#include <vulkan/vulkan_core.h>
+//
+
+// Core
+#include <Defs.h>
+//
+
+// STL
+#include <map>
+#include <vector>
+//
+
+namespace Render {
+
+	// Forward declare
+	class GDevice;
+
+	/// <summary>
+	/// Range of a memory block handed out by GAllocator
+	/// </summary>
+	struct GAllocation {
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		VkDeviceSize offset = 0;
+		VkDeviceSize size = 0;
+
+		uint32_t memType = 0;
+		uint32_t block = 0;
+
+		// Start of the range in host visible memory, nullptr otherwise
+		void* mapped = nullptr;
+	};
+
+	/// <summary>
+	/// Usage of one memory type
+	/// </summary>
+	struct GMemoryStats {
+		uint32_t memType = 0;
+		VkMemoryPropertyFlags flags = 0;
+
+		// Bytes handed out and bytes taken from the driver
+		VkDeviceSize liveBytes = 0;
+		VkDeviceSize blockBytes = 0;
+
+		uint32_t allocationCount = 0;
+		uint32_t blockCount = 0;
+	};
+
+	/// <summary>
+	/// Pooled GPU memory allocator.
+	/// 
+	/// Memory is taken from the driver in large blocks per memory type and handed out
+	/// as aligned ranges. Freed ranges go back to the free list of their block and are merged
+	/// with their neighbours. Host visible blocks are mapped once, when they are created,
+	/// so sub-allocations must be written through GAllocation::mapped instead of vkMapMemory.
+	/// Only buffers are placed in the blocks, bufferImageGranularity never comes into play.
+	/// </summary>
+	class GAllocator {
+	public:
+		NO_COPY(GAllocator);
+
+		GAllocator(GDevice& device);
+		~GAllocator();
+
+		/// <summary>
+		/// Sub-allocates memReq.size bytes of a memory type with the given properties
+		/// </summary>
+		/// <param name="memReq">const VkMemoryRequirements&</param>
+		/// <param name="props">VkMemoryPropertyFlags</param>
+		/// <returns>GAllocation</returns>
+		[[nodiscard]] GAllocation Allocate(const VkMemoryRequirements& memReq, VkMemoryPropertyFlags props);
+
+		/// <summary>
+		/// Returns the range to its block and resets the allocation
+		/// </summary>
+		/// <param name="allocation">GAllocation&</param>
+		void Free(GAllocation& allocation);
+
+		/// <summary>
+		/// Usage of every memory type that holds at least one block
+		/// </summary>
+		/// <returns>std::vector<GMemoryStats></returns>
+		std::vector<GMemoryStats> GetStats() const;
+
+		VkDeviceSize GetLiveBytes(uint32_t memType) const;
+
+	private:
+		struct Block {
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+			VkDeviceSize size = 0;
+			void* mapped = nullptr;
+
+			// Free ranges, offset -> size
+			std::map<VkDeviceSize, VkDeviceSize> freeRanges;
+
+			VkDeviceSize liveBytes = 0;
+			uint32_t allocationCount = 0;
+		};
+
+		// Blocks of one memory type, released blocks leave an empty slot so indices stay valid
+		struct Pool {
+			std::vector<Block> blocks;
+		};
+
+		bool AllocateFromBlock(Block& block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset);
+		uint32_t CreateBlock(uint32_t memType, VkDeviceSize size);
+		void DestroyBlock(Block& block);
+
+		GDevice* m_Device;
+		VkPhysicalDeviceMemoryProperties m_MemProps{};
+
+		std::vector<Pool> m_Pools;
+
+		static constexpr VkDeviceSize s_BlockSize = 64ull * 1024 * 1024;
+	};
+
+}
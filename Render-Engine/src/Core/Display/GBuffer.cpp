@@ -12,7 +12,10 @@ namespace Render {
 		, VkBufferUsageFlags usgFlags
 		, VkMemoryPropertyFlags props
 		, VkBuffer& buffer
-		, VkDeviceMemory& bufferMem) {
+		, GAllocation& allocation
+		, bool computeShared) {
+
+		const uint32_t families[] = { device->GetGraphicsFamily(), device->GetComputeFamily() };
 
 		VkBufferCreateInfo bufferInfo{};
 		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -20,38 +23,33 @@ namespace Render {
 		bufferInfo.usage = usgFlags;
 		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+		// Saves the queue family ownership transfers between the compute and the graphics submit
+		if (computeShared && families[0] != families[1]) {
+			bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+			bufferInfo.queueFamilyIndexCount = 2;
+			bufferInfo.pQueueFamilyIndices = families;
+		}
+
 		if (vkCreateBuffer(device->GetDevice(), &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
 			throw std::runtime_error("Failed to create vertex buffer!");
 
 		VkMemoryRequirements bufferMemReq{};
 		vkGetBufferMemoryRequirements(device->GetDevice(), buffer, &bufferMemReq);
 
-		VkMemoryAllocateInfo mallocInfo{};
-		mallocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		mallocInfo.allocationSize = bufferMemReq.size;
-		mallocInfo.memoryTypeIndex = device->GetMemType(bufferMemReq.memoryTypeBits, props);
-
-		if (vkAllocateMemory(device->GetDevice(), &mallocInfo, nullptr, &bufferMem) != VK_SUCCESS)
-			throw std::runtime_error("Failed to allocate memory for the vertex buffer!");
+		allocation = device->GetAllocator().Allocate(bufferMemReq, props);
 
-		vkBindBufferMemory(device->GetDevice(), buffer, bufferMem, 0);
+		vkBindBufferMemory(device->GetDevice(), buffer, allocation.memory, allocation.offset);
 	}
 
-	void GBuffer::CopyBuffer(
+	void GBuffer::DestroyBuffer(
 		  GDevice* device
-		, VkBuffer srcBuffer
-		, VkBuffer dstBuffer
-		, VkDeviceSize size) {
-
-		VkCommandBuffer cmdBuffer = device->BeginSTCommands();
+		, VkBuffer& buffer
+		, GAllocation& allocation) {
 
-		VkBufferCopy bufferCopy{};
-		bufferCopy.size = size;
-		bufferCopy.srcOffset = 0;
-		bufferCopy.dstOffset = 0;
-		vkCmdCopyBuffer(cmdBuffer, srcBuffer, dstBuffer, 1, &bufferCopy);
+		vkDestroyBuffer(device->GetDevice(), buffer, nullptr);
+		device->GetAllocator().Free(allocation);
 
-		device->EndSTCommands(cmdBuffer);
+		buffer = VK_NULL_HANDLE;
 	}
 
-}
+}
\ No newline at end of file
@@ -4,6 +4,10 @@
 #include <vulkan/vulkan_core.h>
 //
 
+// Core
+#include "GAllocator.h"
+//
+
 namespace Render {
 
 	// Forward declare
@@ -14,33 +18,33 @@ namespace Render {
 		GBuffer() = default;
 		GBuffer(const GBuffer& rhs)
 			: m_Buffer(rhs.m_Buffer)
-			, m_BufferMem(rhs.m_BufferMem)
+			, m_Allocation(rhs.m_Allocation)
 			, m_Size(rhs.m_Size)
 			, m_UsageFlags(rhs.m_UsageFlags)
 			, m_MemFlags(rhs.m_MemFlags) {};
 
 
-		// Creates VkBuffer
+		// Creates VkBuffer, its memory is sub-allocated from the device's GAllocator.
+		// Buffers the compute queue touches as well are shared concurrently when it has its own family.
 		static void CreateBuffer(
 			  GDevice* device
 			, VkDeviceSize size
 			, VkBufferUsageFlags usgFlags
 			, VkMemoryPropertyFlags props
 			, VkBuffer& buffer
-			, VkDeviceMemory& bufferMem
+			, GAllocation& allocation
+			, bool computeShared = false
 		);
 
-		// Copies VkBuffer
-		static void CopyBuffer(
+		// Destroys VkBuffer and gives its memory back to the allocator
+		static void DestroyBuffer(
 			  GDevice* device
-			, VkBuffer srcBuffer
-			, VkBuffer dstBuffer
-			, VkDeviceSize size
+			, VkBuffer& buffer
+			, GAllocation& allocation
 		);
 
-
 		inline VkBuffer&				GetVkBuffer() { return m_Buffer; }
-		inline VkDeviceMemory&			GetVkDeviceMem() { return m_BufferMem; }
+		inline GAllocation&				GetAllocation() { return m_Allocation; }
 		inline VkDeviceSize&			GetVkDeviceSize() { return m_Size; }
 		inline VkBufferUsageFlags		GetVkBufferUsageFlags() { return m_UsageFlags; }
 		inline VkMemoryPropertyFlags	GetVkMemFlags() { return m_MemFlags; }
@@ -50,7 +54,7 @@ namespace Render {
 		//GDevice& m_Device;
 
 		VkBuffer m_Buffer			= VK_NULL_HANDLE;
-		VkDeviceMemory m_BufferMem	= VK_NULL_HANDLE;
+		GAllocation m_Allocation{};
 
 		VkDeviceSize m_Size;
 		VkBufferUsageFlags m_UsageFlags;
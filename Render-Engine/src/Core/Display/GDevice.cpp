@@ -1,5 +1,7 @@
 #include "pch.h"
 #include "GDevice.h"
+#include "GAllocator.h"
+#include "GUploader.h"
 
 // Vulkan
 #include <vulkan/vulkan.h>
@@ -25,6 +27,9 @@ namespace Render {
 		PickPhysicalDevice();
 		CreateLogicalDevice();
 		CreateCommandPool();
+
+		m_Allocator = new GAllocator{ *this };
+		m_Uploader = new GUploader{ *this };
 	}
 	
 	GDevice::GDevice(Window& window) {
@@ -35,9 +40,16 @@ namespace Render {
 		PickPhysicalDevice();
 		CreateLogicalDevice();
 		CreateCommandPool();
+
+		m_Allocator = new GAllocator{ *this };
+		m_Uploader = new GUploader{ *this };
 	}
 
 	GDevice::~GDevice() {
+		delete m_Uploader;
+		delete m_Allocator;
+
+		vkDestroyCommandPool(m_Device, m_ComputeCommandPool, nullptr);
 		vkDestroyCommandPool(m_Device, m_ComandPool, nullptr);
 		vkDestroyDevice(m_Device, nullptr);
 
@@ -184,17 +196,33 @@ namespace Render {
 	void GDevice::CreateLogicalDevice() {
 		QFamilyInd ind = GetQFamilies(m_PhysicalDevice);
 
+		m_GraphicsFamily = ind.graphicsFamily.value();
+		m_ComputeFamily = ind.computeFamily.value();
+
+		uint32_t qFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(m_PhysicalDevice, &qFamilyCount, nullptr);
+
+		std::vector<VkQueueFamilyProperties> qFamilies(qFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(m_PhysicalDevice, &qFamilyCount, qFamilies.data());
+
+		// Without a compute only family a second queue of the graphics family still runs
+		// compute next to the draws, when the family has one
+		uint32_t computeQueueIndex = 0;
+		if (m_ComputeFamily == m_GraphicsFamily && qFamilies[m_GraphicsFamily].queueCount > 1)
+			computeQueueIndex = 1;
+
 		std::vector<VkDeviceQueueCreateInfo> qCreateInfos;
-		std::set<uint32_t> uniqueQFams = { ind.graphicsFamily.value(), ind.presentFamily.value() };
+		std::set<uint32_t> uniqueQFams = { ind.graphicsFamily.value(), ind.presentFamily.value(), ind.computeFamily.value() };
 
-		float qPriority = 1.0f;
+		// Simulation compute gets a lower priority than the frame it feeds
+		float qPriorities[] = { 1.0f, 0.5f };
 
 		for (uint32_t elem : uniqueQFams) {
 			VkDeviceQueueCreateInfo qCreateInfo{};
 			qCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
 			qCreateInfo.queueFamilyIndex = elem;
-			qCreateInfo.queueCount = 1;
-			qCreateInfo.pQueuePriorities = &qPriority;
+			qCreateInfo.queueCount = elem == m_GraphicsFamily ? 1 + computeQueueIndex : 1;
+			qCreateInfo.pQueuePriorities = elem == m_ComputeFamily && elem != m_GraphicsFamily ? &qPriorities[1] : qPriorities;
 			qCreateInfos.push_back(qCreateInfo);
 		}
 
@@ -221,7 +249,7 @@ namespace Render {
 			throw std::runtime_error("Failed to create logical device!");
 
 		vkGetDeviceQueue(m_Device, ind.graphicsFamily.value(), 0, &m_GraphicsQueue);
-		vkGetDeviceQueue(m_Device, ind.graphicsFamily.value(), 0, &m_ComputeQueue);
+		vkGetDeviceQueue(m_Device, ind.computeFamily.value(), computeQueueIndex, &m_ComputeQueue);
 		vkGetDeviceQueue(m_Device, ind.presentFamily.value(), 0, &m_PresentQueue);
 	}
 
@@ -235,6 +263,11 @@ namespace Render {
 
 		if (vkCreateCommandPool(m_Device, &commandPoolInfo, nullptr, &m_ComandPool) != VK_SUCCESS)
 			throw std::runtime_error("Failed to create command pool!");
+
+		commandPoolInfo.queueFamilyIndex = qFamInds.computeFamily.value();
+
+		if (vkCreateCommandPool(m_Device, &commandPoolInfo, nullptr, &m_ComputeCommandPool) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create compute command pool!");
 	}
 
 	bool GDevice::IsDeviceSuitable(VkPhysicalDevice device) {
@@ -321,24 +354,31 @@ namespace Render {
 		std::vector<VkQueueFamilyProperties> qFamilies(qFamilyCount);
 		vkGetPhysicalDeviceQueueFamilyProperties(device, &qFamilyCount, qFamilies.data());
 
-		uint16_t i = 0;
+		uint32_t i = 0;
 
+		// Every family is looked at, a compute only family may come after the graphics one
 		for (const auto& elem : qFamilies) {
-			if ((elem.queueFlags & VK_QUEUE_GRAPHICS_BIT) && (elem.queueFlags & VK_QUEUE_COMPUTE_BIT))
+			const bool graphics = (elem.queueFlags & VK_QUEUE_GRAPHICS_BIT) && (elem.queueFlags & VK_QUEUE_COMPUTE_BIT);
+
+			if (graphics && !ind.graphicsFamily.has_value())
 				ind.graphicsFamily = i;
 
+			if (!(elem.queueFlags & VK_QUEUE_GRAPHICS_BIT) && (elem.queueFlags & VK_QUEUE_COMPUTE_BIT) && !ind.computeFamily.has_value())
+				ind.computeFamily = i;
+
 			VkBool32 presentSupport = false;
 			vkGetPhysicalDeviceSurfaceSupportKHR(device, i, m_Surface, &presentSupport);
 
-			if (presentSupport)
-				ind.presentFamily = 1;
-
-			if (ind.IsComplete())
-				break;
+			// Presenting from the graphics family saves a queue ownership transfer
+			if (presentSupport && (!ind.presentFamily.has_value() || (graphics && ind.graphicsFamily.value() == i)))
+				ind.presentFamily = i;
 
 			i++;
 		}
 
+		if (!ind.computeFamily.has_value())
+			ind.computeFamily = ind.graphicsFamily;
+
 		return ind;
 	}
 
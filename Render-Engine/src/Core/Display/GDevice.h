@@ -17,6 +17,10 @@
 
 namespace Render {
 
+	// Forward declare
+	class GAllocator;
+	class GUploader;
+
 	/// <summary>
 	/// Graphics Device
 	/// </summary>
@@ -30,6 +34,7 @@ namespace Render {
 		~GDevice();
 		
 		inline VkCommandPool&		GetCommandPool() { return m_ComandPool; }
+		inline VkCommandPool&		GetComputeCommandPool() { return m_ComputeCommandPool; }
 		inline VkDevice&			GetDevice() { return m_Device; }
 		inline VkPhysicalDevice&	GetPhysicalDevice() { return m_PhysicalDevice; }
 		inline VkSurfaceKHR&		GetSurface() { return m_Surface; }
@@ -38,6 +43,16 @@ namespace Render {
 		inline VkQueue&				GetPresentQueue() { return m_PresentQueue; }
 		inline Window*				GetWindow() { return m_pWindow; }
 		inline VkInstance&			GetInstance() { return m_VkInstance; }
+		inline GAllocator&			GetAllocator() { return *m_Allocator; }
+		inline GUploader&			GetUploader() { return *m_Uploader; }
+		inline uint32_t				GetGraphicsFamily() const { return m_GraphicsFamily; }
+		inline uint32_t				GetComputeFamily() const { return m_ComputeFamily; }
+
+		/// <summary>
+		/// True when compute is submitted to a different queue than graphics and can overlap the draws
+		/// </summary>
+		/// <returns>bool</returns>
+		inline bool					HasAsyncCompute() const { return m_ComputeQueue != m_GraphicsQueue; }
 
 		/// <summary>
 		/// Returns the a command buffer for single time commands
@@ -123,6 +138,18 @@ namespace Render {
 		VkQueue m_GraphicsQueue;
 		VkQueue	m_PresentQueue;
 		VkQueue m_ComputeQueue;
+
+		uint32_t m_GraphicsFamily = 0;
+		uint32_t m_ComputeFamily = 0;
+
+		// Compute command buffers are recorded for the compute family, which may differ from the graphics one
+		VkCommandPool m_ComputeCommandPool = VK_NULL_HANDLE;
+
+		// Sub-allocates the memory of every buffer
+		GAllocator* m_Allocator = nullptr;
+
+		// Batches the buffer uploads through a staging ring
+		GUploader* m_Uploader = nullptr;
 	};
 
 }
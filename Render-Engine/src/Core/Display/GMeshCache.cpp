@@ -0,0 +1,195 @@
+#include "pch.h"
+#include "GMeshCache.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// STL
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+//
+
+namespace Render {
+
+	GMappedFile::~GMappedFile() {
+		Close();
+	}
+
+	bool GMappedFile::Open(const std::string& path) {
+		Close();
+
+#ifdef _WIN32
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER size{};
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping) {
+			CloseHandle(file);
+			return false;
+		}
+
+		const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!data) {
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		m_File = file;
+		m_Mapping = mapping;
+		m_Data = static_cast<const uint8_t*>(data);
+		m_Size = static_cast<size_t>(size.QuadPart);
+#else
+		const int file = open(path.c_str(), O_RDONLY);
+		if (file < 0)
+			return false;
+
+		struct stat info{};
+		if (fstat(file, &info) != 0 || info.st_size == 0) {
+			close(file);
+			return false;
+		}
+
+		void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		close(file);
+
+		if (data == MAP_FAILED)
+			return false;
+
+		m_Data = static_cast<const uint8_t*>(data);
+		m_Size = static_cast<size_t>(info.st_size);
+#endif
+
+		return true;
+	}
+
+	void GMappedFile::Close() {
+		if (!m_Data)
+			return;
+
+#ifdef _WIN32
+		UnmapViewOfFile(m_Data);
+		CloseHandle(m_Mapping);
+		CloseHandle(m_File);
+#else
+		munmap(const_cast<uint8_t*>(m_Data), m_Size);
+#endif
+
+		m_Data = nullptr;
+		m_Size = 0;
+		m_File = nullptr;
+		m_Mapping = nullptr;
+	}
+
+	uint64_t GMeshCache::Hash(const uint8_t* data, size_t size) {
+		auto mix = [](uint64_t h) {
+			h ^= h >> 33;
+			h *= 0xff51afd7ed558ccdull;
+			h ^= h >> 33;
+			h *= 0xc4ceb9fe1a85ec53ull;
+			h ^= h >> 33;
+			return h;
+		};
+
+		uint64_t hash = 0x9e3779b97f4a7c15ull ^ size;
+		size_t i = 0;
+
+		for (; i + 8 <= size; i += 8) {
+			uint64_t word;
+			memcpy(&word, data + i, 8);
+			hash = mix(hash ^ word) + i;
+		}
+
+		uint64_t tail = 0;
+		memcpy(&tail, data + i, size - i);
+
+		return mix(hash ^ tail);
+	}
+
+	std::string GMeshCache::GetCachePath(const std::string& sourcePath) {
+		return sourcePath + ".mesh";
+	}
+
+	const GMeshHeader* GMeshCache::Open(const std::string& cachePath, uint64_t sourceHash, GMappedFile& file) {
+		if (!file.Open(cachePath) || file.GetSize() < sizeof(GMeshHeader))
+			return nullptr;
+
+		const GMeshHeader* header = reinterpret_cast<const GMeshHeader*>(file.GetData());
+
+		const bool valid = header->magic == s_Magic
+			&& header->version == s_Version
+			&& header->sourceHash == sourceHash
+			&& header->vertexStride == sizeof(Vertex)
+			&& (header->indexStride == sizeof(uint16_t) || header->indexStride == sizeof(uint32_t))
+			&& header->vertexOffset + static_cast<uint64_t>(header->vertexCount) * sizeof(Vertex) <= file.GetSize()
+			&& header->indexOffset + static_cast<uint64_t>(header->indexCount) * header->indexStride <= file.GetSize();
+
+		if (!valid) {
+			file.Close();
+			return nullptr;
+		}
+
+		return header;
+	}
+
+	void GMeshCache::Write(
+		  const std::string& cachePath
+		, uint64_t sourceHash
+		, const std::vector<Vertex>& vertices
+		, const void* indices
+		, uint32_t indexCount
+		, uint32_t indexStride
+		, const GMeshStats& stats) {
+
+		GMeshHeader header{};
+		header.magic = s_Magic;
+		header.version = s_Version;
+		header.sourceHash = sourceHash;
+		header.vertexStride = sizeof(Vertex);
+		header.vertexCount = static_cast<uint32_t>(vertices.size());
+		header.indexCount = indexCount;
+		header.indexStride = indexStride;
+		header.vertexOffset = sizeof(GMeshHeader);
+		header.indexOffset = header.vertexOffset + vertices.size() * sizeof(Vertex);
+		header.stats = stats;
+
+		// A partly written file would be rejected by its size check, but never replaces a good one
+		const std::string tempPath = cachePath + ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+
+			if (!file.is_open())
+				return;
+
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(vertices.data()), vertices.size() * sizeof(Vertex));
+			file.write(static_cast<const char*>(indices), static_cast<std::streamsize>(indexCount) * indexStride);
+
+			if (!file) {
+				file.close();
+				std::remove(tempPath.c_str());
+				return;
+			}
+		}
+
+		std::remove(cachePath.c_str());
+		std::rename(tempPath.c_str(), cachePath.c_str());
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+#pragma once
+
+// Core
+#include <Defs.h>
+#include <Core/Graphics/Vertex.h>
+#include "GMeshOptimizer.h"
+//
+
+// STL
+#include <cstdint>
+#include <string>
+#include <vector>
+//
+
+namespace Render {
+
+	/// <summary>
+	/// Read only memory mapping of a whole file
+	/// </summary>
+	class GMappedFile {
+	public:
+		NO_COPY(GMappedFile);
+
+		GMappedFile() = default;
+		~GMappedFile();
+
+		/// <summary>
+		/// Maps the file, returns false when it does not exist or is empty
+		/// </summary>
+		/// <param name="path">const std::string&</param>
+		/// <returns>bool</returns>
+		bool Open(const std::string& path);
+		void Close();
+
+		inline const uint8_t*	GetData() const { return m_Data; }
+		inline size_t			GetSize() const { return m_Size; }
+
+	private:
+		const uint8_t* m_Data = nullptr;
+		size_t m_Size = 0;
+
+		// File and mapping handles, only used on Windows
+		void* m_File = nullptr;
+		void* m_Mapping = nullptr;
+	};
+
+	/// <summary>
+	/// Layout of a .mesh file, the vertex and index blobs follow at their offsets
+	/// </summary>
+	struct GMeshHeader {
+		uint32_t magic;
+		uint32_t version;
+
+		// Hash of the source file the mesh was built from
+		uint64_t sourceHash;
+
+		uint32_t vertexStride;
+		uint32_t vertexCount;
+		uint32_t indexCount;
+
+		// 2 or 4 bytes
+		uint32_t indexStride;
+
+		uint64_t vertexOffset;
+		uint64_t indexOffset;
+
+		// Simulated vertex shader invocations of one draw before and after the optimization
+		GMeshStats stats;
+	};
+
+	/// <summary>
+	/// Preprocessed meshes stored next to their source as path + ".mesh".
+	/// A cache file is only used while its source hash matches the source on disk,
+	/// so editing the source rebuilds it on the next load.
+	/// </summary>
+	class GMeshCache {
+	public:
+		/// <summary>
+		/// 64 bit hash of the bytes, 8 bytes per round
+		/// </summary>
+		static uint64_t Hash(const uint8_t* data, size_t size);
+
+		static std::string GetCachePath(const std::string& sourcePath);
+
+		/// <summary>
+		/// Maps the cache file and checks it against the source hash and the Vertex layout
+		/// </summary>
+		/// <returns>The header inside the mapping, nullptr when the cache can't be used</returns>
+		static const GMeshHeader* Open(const std::string& cachePath, uint64_t sourceHash, GMappedFile& file);
+
+		/// <summary>
+		/// Writes the mesh with indexCount indices of indexStride bytes, a cache that can't be written is skipped silently
+		/// </summary>
+		static void Write(
+			  const std::string& cachePath
+			, uint64_t sourceHash
+			, const std::vector<Vertex>& vertices
+			, const void* indices
+			, uint32_t indexCount
+			, uint32_t indexStride
+			, const GMeshStats& stats
+		);
+
+	private:
+		static constexpr uint32_t s_Magic = 0x4853454d; // "MESH"
+		static constexpr uint32_t s_Version = 2;
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,264 @@
+#include "pch.h"
+#include "GMeshOptimizer.h"
+
+// GLM
+#include <glm/glm.hpp>
+//
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+//
+
+namespace Render {
+
+	GMeshStats GMeshOptimizer::Optimize(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+		GMeshStats stats{};
+		stats.transformsBefore = SimulateTransforms(indices, static_cast<uint32_t>(vertices.size()));
+
+		const std::vector<uint32_t> clusters = OptimizeVertexCache(indices, static_cast<uint32_t>(vertices.size()));
+		OptimizeOverdraw(indices, clusters, vertices);
+		OptimizeVertexFetch(vertices, indices);
+
+		stats.transformsAfter = SimulateTransforms(indices, static_cast<uint32_t>(vertices.size()));
+		return stats;
+	}
+
+	std::vector<uint32_t> GMeshOptimizer::OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount) {
+		const uint32_t triCount = static_cast<uint32_t>(indices.size() / 3);
+		std::vector<uint32_t> clusters;
+
+		if (triCount == 0)
+			return clusters;
+
+		// Triangles of every vertex, the live ones of vertex v are adjacency[offsets[v], offsets[v] + remaining[v])
+		std::vector<uint32_t> remaining(vertexCount, 0);
+		for (uint32_t i = 0; i < triCount * 3; i++)
+			remaining[indices[i]]++;
+
+		std::vector<uint32_t> offsets(vertexCount + 1, 0);
+		for (uint32_t v = 0; v < vertexCount; v++)
+			offsets[v + 1] = offsets[v] + remaining[v];
+
+		std::vector<uint32_t> adjacency(triCount * 3);
+		{
+			std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+			for (uint32_t i = 0; i < triCount * 3; i++)
+				adjacency[fill[indices[i]]++] = i / 3;
+		}
+
+		std::vector<int32_t> cachePos(vertexCount, -1);
+		std::vector<float> vertexScore(vertexCount);
+		for (uint32_t v = 0; v < vertexCount; v++)
+			vertexScore[v] = VertexScore(-1, remaining[v]);
+
+		std::vector<float> triScore(triCount);
+		for (uint32_t t = 0; t < triCount; t++)
+			triScore[t] = vertexScore[indices[t * 3 + 0]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+		std::vector<bool> emitted(triCount, false);
+		std::vector<uint32_t> ordered;
+		ordered.reserve(triCount * 3);
+
+		// Most recently used first, holds up to three entries more than the cache while it is updated
+		std::vector<uint32_t> cache, nextCache;
+		cache.reserve(s_CacheSize + 3);
+		nextCache.reserve(s_CacheSize + 3);
+
+		uint32_t bestTri = UINT32_MAX;
+		uint32_t scanCursor = 0;
+
+		for (uint32_t emittedCount = 0; emittedCount < triCount; emittedCount++) {
+			// Nothing in the cache touches a live triangle, continue with the next one in input order
+			if (bestTri == UINT32_MAX) {
+				while (emitted[scanCursor])
+					scanCursor++;
+
+				bestTri = scanCursor;
+				clusters.push_back(emittedCount);
+			}
+
+			emitted[bestTri] = true;
+
+			const uint32_t* tri = &indices[bestTri * 3];
+			ordered.insert(ordered.end(), tri, tri + 3);
+
+			for (int k = 0; k < 3; k++) {
+				const uint32_t v = tri[k];
+				uint32_t* live = &adjacency[offsets[v]];
+
+				for (uint32_t a = 0; a < remaining[v]; a++)
+					if (live[a] == bestTri) {
+						std::swap(live[a], live[remaining[v] - 1]);
+						break;
+					}
+
+				remaining[v]--;
+			}
+
+			nextCache.assign(tri, tri + 3);
+			for (uint32_t v : cache)
+				if (v != tri[0] && v != tri[1] && v != tri[2])
+					nextCache.push_back(v);
+
+			// Entries past the cache size fell out, their score drops with their position
+			for (uint32_t pos = 0; pos < nextCache.size(); pos++) {
+				const uint32_t v = nextCache[pos];
+				cachePos[v] = pos < s_CacheSize ? static_cast<int32_t>(pos) : -1;
+				vertexScore[v] = VertexScore(cachePos[v], remaining[v]);
+			}
+
+			bestTri = UINT32_MAX;
+			float bestScore = -1.0f;
+
+			for (uint32_t v : nextCache) {
+				for (uint32_t a = 0; a < remaining[v]; a++) {
+					const uint32_t t = adjacency[offsets[v] + a];
+					triScore[t] = vertexScore[indices[t * 3 + 0]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+					if (triScore[t] > bestScore) {
+						bestScore = triScore[t];
+						bestTri = t;
+					}
+				}
+			}
+
+			if (nextCache.size() > s_CacheSize)
+				nextCache.resize(s_CacheSize);
+
+			std::swap(cache, nextCache);
+		}
+
+		indices.swap(ordered);
+		return clusters;
+	}
+
+	void GMeshOptimizer::OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<uint32_t>& clusters, const std::vector<Vertex>& vertices) {
+		const uint32_t triCount = static_cast<uint32_t>(indices.size() / 3);
+
+		if (clusters.size() < 2)
+			return;
+
+		auto triangle = [&](uint32_t t, glm::vec3& a, glm::vec3& b, glm::vec3& c) {
+			a = vertices[indices[t * 3 + 0]].pos;
+			b = vertices[indices[t * 3 + 1]].pos;
+			c = vertices[indices[t * 3 + 2]].pos;
+		};
+
+		// Area weighted center of the whole mesh
+		glm::vec3 meshCenter{ 0.0f };
+		float meshArea = 0.0f;
+
+		for (uint32_t t = 0; t < triCount; t++) {
+			glm::vec3 a, b, c;
+			triangle(t, a, b, c);
+
+			const float area = glm::length(glm::cross(b - a, c - a));
+			meshCenter += (a + b + c) * (area / 3.0f);
+			meshArea += area;
+		}
+
+		meshCenter = meshArea > 0.0f ? meshCenter / meshArea : meshCenter;
+
+		// Clusters whose faces point outwards from the center are likely in front of the rest
+		std::vector<float> sortKey(clusters.size());
+
+		for (size_t c = 0; c < clusters.size(); c++) {
+			const uint32_t begin = clusters[c];
+			const uint32_t end = c + 1 < clusters.size() ? clusters[c + 1] : triCount;
+
+			glm::vec3 center{ 0.0f };
+			glm::vec3 normal{ 0.0f };
+			float area = 0.0f;
+
+			for (uint32_t t = begin; t < end; t++) {
+				glm::vec3 p0, p1, p2;
+				triangle(t, p0, p1, p2);
+
+				const glm::vec3 faceNormal = glm::cross(p1 - p0, p2 - p0);
+				const float faceArea = glm::length(faceNormal);
+
+				center += (p0 + p1 + p2) * (faceArea / 3.0f);
+				normal += faceNormal;
+				area += faceArea;
+			}
+
+			center = area > 0.0f ? center / area : center;
+
+			const float normalLength = glm::length(normal);
+			sortKey[c] = normalLength > 0.0f ? glm::dot(center - meshCenter, normal / normalLength) : 0.0f;
+		}
+
+		std::vector<uint32_t> order(clusters.size());
+		std::iota(order.begin(), order.end(), 0u);
+		std::stable_sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) { return sortKey[lhs] > sortKey[rhs]; });
+
+		std::vector<uint32_t> sorted;
+		sorted.reserve(indices.size());
+
+		for (uint32_t c : order) {
+			const uint32_t begin = clusters[c];
+			const uint32_t end = c + 1 < clusters.size() ? clusters[c + 1] : triCount;
+
+			sorted.insert(sorted.end(), indices.begin() + begin * 3, indices.begin() + end * 3);
+		}
+
+		indices.swap(sorted);
+	}
+
+	void GMeshOptimizer::OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+		std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+		std::vector<Vertex> ordered;
+		ordered.reserve(vertices.size());
+
+		for (uint32_t& index : indices) {
+			if (remap[index] == UINT32_MAX) {
+				remap[index] = static_cast<uint32_t>(ordered.size());
+				ordered.push_back(vertices[index]);
+			}
+
+			index = remap[index];
+		}
+
+		vertices.swap(ordered);
+	}
+
+	uint32_t GMeshOptimizer::SimulateTransforms(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize) {
+		// Time stamp of the last transform of every vertex, a vertex is cached while fewer than
+		// cacheSize other transforms happened since
+		std::vector<uint32_t> stamp(vertexCount, 0);
+		uint32_t transforms = 0;
+
+		for (uint32_t index : indices) {
+			if (stamp[index] == 0 || transforms - stamp[index] >= cacheSize) {
+				transforms++;
+				stamp[index] = transforms;
+			}
+		}
+
+		return transforms;
+	}
+
+	float GMeshOptimizer::VertexScore(int32_t cachePos, uint32_t remainingTris) {
+		// Vertices without triangles left are never picked again
+		if (remainingTris == 0)
+			return -1.0f;
+
+		float score = 0.0f;
+
+		if (cachePos >= 0) {
+			// The last triangle's vertices get a fixed score so the next one doesn't just reuse them
+			if (cachePos < 3)
+				score = 0.75f;
+			else
+				score = std::pow(1.0f - static_cast<float>(cachePos - 3) / (s_CacheSize - 3), 1.5f);
+		}
+
+		// Vertices with few triangles left are finished off first
+		score += 2.0f * std::pow(static_cast<float>(remainingTris), -0.5f);
+
+		return score;
+	}
+
+}
\ No newline at end of file
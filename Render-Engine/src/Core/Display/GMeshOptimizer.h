@@ -0,0 +1,69 @@
+#pragma once
+
+// Core
+#include <Core/Graphics/Vertex.h>
+//
+
+// STL
+#include <cstdint>
+#include <vector>
+//
+
+namespace Render {
+
+	/// <summary>
+	/// Vertex shader invocations of one draw of a mesh, counted with a simulated FIFO post-transform cache
+	/// </summary>
+	struct GMeshStats {
+		uint32_t transformsBefore = 0;
+		uint32_t transformsAfter = 0;
+	};
+
+	/// <summary>
+	/// Reorders indexed triangle lists for the GPU, runs once when a mesh is built.
+	///
+	/// Triangles are ordered for the post-transform vertex cache (Forsyth's linear-speed
+	/// algorithm), the clusters that order naturally falls into are sorted so faces facing away
+	/// from the mesh center come first to cut overdraw, and vertices are renumbered in the
+	/// order the indices first use them so the vertex fetch walks memory forwards.
+	/// </summary>
+	class GMeshOptimizer {
+	public:
+		/// <summary>
+		/// Runs every stage, unreferenced vertices are dropped
+		/// </summary>
+		/// <returns>GMeshStats of the mesh before and after</returns>
+		static GMeshStats Optimize(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+		/// <summary>
+		/// Reorders the triangles, returns the first triangle of every cluster.
+		/// A cluster starts where the order had to jump to a triangle with nothing in the cache.
+		/// </summary>
+		static std::vector<uint32_t> OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount);
+
+		/// <summary>
+		/// Sorts whole clusters front to back as seen from outside the mesh
+		/// </summary>
+		static void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<uint32_t>& clusters, const std::vector<Vertex>& vertices);
+
+		/// <summary>
+		/// Renumbers the vertices in order of first use
+		/// </summary>
+		static void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+		/// <summary>
+		/// Vertex shader invocations of the index list with a FIFO cache of cacheSize entries
+		/// </summary>
+		static uint32_t SimulateTransforms(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize = s_SimulatedCacheSize);
+
+		// Entries of the FIFO used for the stats, close to what desktop GPUs reuse in practice
+		static constexpr uint32_t s_SimulatedCacheSize = 16;
+
+	private:
+		static float VertexScore(int32_t cachePos, uint32_t remainingTris);
+
+		// LRU size the ordering is tuned for
+		static constexpr uint32_t s_CacheSize = 32;
+	};
+
+}
\ No newline at end of file
@@ -4,6 +4,9 @@
 // Core
 #include "GBuffer.h"
 #include "GDevice.h"
+#include "GUploader.h"
+#include "GMeshCache.h"
+#include "GMeshOptimizer.h"
 //
 
 // Vulkan
@@ -15,6 +18,7 @@
 //
 
 // STL
+#include <cstring>
 #include <unordered_map>
 #include <functional>
 //
@@ -28,11 +32,27 @@ namespace std {
 	template<>
 	struct std::hash<::Vertex> {
 		size_t operator()(::Vertex const& vert) const {
-			size_t seed = 0;
-			return ((std::hash<::glm::vec3>()(vert.pos))
-				^ (std::hash<::glm::vec4>()(vert.color) << 1)) >> 1
-				^ (std::hash<::glm::vec2>()(vert.uv) << 1)
-				^ (std::hash<::glm::vec3>()(vert.normal) << 2) >> 1;
+			const float fields[] = {
+				  vert.pos.x, vert.pos.y, vert.pos.z
+				, vert.color.r, vert.color.g, vert.color.b, vert.color.a
+				, vert.uv.x, vert.uv.y
+				, vert.normal.x, vert.normal.y, vert.normal.z
+			};
+
+			uint64_t hash = 0x9e3779b97f4a7c15ull;
+			for (float field : fields) {
+				// -0.0f and 0.0f compare equal, so they have to hash equal too
+				if (field == 0.0f)
+					field = 0.0f;
+
+				uint32_t bits;
+				memcpy(&bits, &field, sizeof(bits));
+
+				hash = (hash ^ bits) * 0xff51afd7ed558ccdull;
+				hash ^= hash >> 32;
+			}
+
+			return static_cast<size_t>(hash);
 		}
 	};
 }
@@ -44,13 +64,66 @@ namespace Render {
 
 		m_Device = &device;
 		LoadModel(modelPath);
-		CreateVertexBuffers(m_Vertices);
-		CreateIndexBuffers(m_Indices);
 	}
 
-	GModel::~GModel() {};
+	// The ranges go back to the device's GAllocator, models have to go before it does
+	GModel::~GModel() {
+		GBuffer::DestroyBuffer(m_Device, m_IndexBuffer->GetVkBuffer(), m_IndexBufferMem);
+		GBuffer::DestroyBuffer(m_Device, m_VertexBuffer->GetVkBuffer(), m_VertexBufferMem);
+	}
 
 	void GModel::LoadModel(const std::string& path) {
+		uint64_t sourceHash = 0;
+		{
+			GMappedFile source;
+			if (!source.Open(path))
+				throw std::runtime_error("Failed to open model " + path + "!");
+
+			sourceHash = GMeshCache::Hash(source.GetData(), source.GetSize());
+		}
+
+		// Cached meshes are uploaded straight from the mapping
+		const std::string cachePath = GMeshCache::GetCachePath(path);
+		GMappedFile cache;
+
+		if (const GMeshHeader* header = GMeshCache::Open(cachePath, sourceHash, cache)) {
+			m_VertexCount = header->vertexCount;
+			m_IndexCount = header->indexCount;
+			m_IndexType = header->indexStride == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+			m_Stats = header->stats;
+
+			CreateVertexBuffers(cache.GetData() + header->vertexOffset);
+			CreateIndexBuffers(cache.GetData() + header->indexOffset);
+			return;
+		}
+
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+		ParseObj(path, vertices, indices);
+
+		// Done once here, the cache keeps the optimized order
+		m_Stats = GMeshOptimizer::Optimize(vertices, indices);
+
+		m_VertexCount = static_cast<uint32_t>(vertices.size());
+		m_IndexCount = static_cast<uint32_t>(indices.size());
+
+		// Halves the index fetch when every vertex is reachable with 16 bits
+		std::vector<uint16_t> indices16;
+		const void* indexData = indices.data();
+
+		if (m_VertexCount <= UINT16_MAX) {
+			indices16.assign(indices.begin(), indices.end());
+			indexData = indices16.data();
+			m_IndexType = VK_INDEX_TYPE_UINT16;
+		}
+
+		GMeshCache::Write(cachePath, sourceHash, vertices, indexData, m_IndexCount, GetIndexStride(), m_Stats);
+
+		CreateVertexBuffers(vertices.data());
+		CreateIndexBuffers(indexData);
+	}
+
+	void GModel::ParseObj(const std::string& path, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
 		tinyobj::attrib_t att;
 		std::vector<tinyobj::shape_t> shapes;
 		std::vector<tinyobj::material_t> materials;
@@ -60,10 +133,17 @@ namespace Render {
 		if (!tinyobj::LoadObj(&att, &shapes, &materials, &warn, &err, path.c_str()))
 			throw std::runtime_error(warn + err);
 
-		m_Indices.clear();
-		m_Vertices.clear();
+		indices.clear();
+		vertices.clear();
 		std::unordered_map <Vertex, uint32_t> uniqueVert;
 
+		size_t indexCount = 0;
+		for (const auto& elem : shapes)
+			indexCount += elem.mesh.indices.size();
+
+		indices.reserve(indexCount);
+		uniqueVert.reserve(att.vertices.size() / 3);
+
 		for (const auto& elem : shapes) {
 			for (const auto& index : elem.mesh.indices) {
 				Vertex vert{};
@@ -88,73 +168,36 @@ namespace Render {
 						, att.normals[3 * index.normal_index + 2]
 					};
 
-				if (uniqueVert.find(vert) == uniqueVert.end()) {
-					uniqueVert[vert] = static_cast<uint32_t>(m_Vertices.size());
-					m_Vertices.push_back(vert);
-				}
+				auto [unique, inserted] = uniqueVert.try_emplace(vert, static_cast<uint32_t>(vertices.size()));
+				if (inserted)
+					vertices.push_back(vert);
 
-				m_Indices.push_back(uniqueVert[vert]);
+				indices.push_back(unique->second);
 			}
 		}
 	}
 
-	void GModel::CreateVertexBuffers(const std::vector<Vertex>& vertices) {
-		VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
-
-		VkBuffer stagingBuffer;
-		VkDeviceMemory stagingBufferMem;
+	void GModel::CreateVertexBuffers(const void* vertices) {
+		VkDeviceSize bufferSize = sizeof(Vertex) * m_VertexCount;
 
 		GBuffer::CreateBuffer(
 			  m_Device
 			, bufferSize
-			, VK_BUFFER_USAGE_TRANSFER_SRC_BIT
-			, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-			, stagingBuffer
-			, stagingBufferMem
-		);
-
-		void* data;
-		vkMapMemory(m_Device->GetDevice(), stagingBufferMem, 0, bufferSize, 0, &data);
-		memcpy(data, m_Vertices.data(), (size_t)bufferSize);
-		vkUnmapMemory(m_Device->GetDevice(), stagingBufferMem);
-
-		GBuffer::CreateBuffer(
-			m_Device
-			, bufferSize
 			, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT
 			, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
 			, m_VertexBuffer->GetVkBuffer()
 			, m_VertexBufferMem
 		);
 
-		GBuffer::CopyBuffer(m_Device, stagingBuffer, m_VertexBuffer->GetVkBuffer(), bufferSize);
-
-		vkDestroyBuffer(m_Device->GetDevice(), stagingBuffer, nullptr);
-		vkFreeMemory(m_Device->GetDevice(), stagingBufferMem, nullptr);
+		// Goes out with the next flush, before the first frame that draws the model
+		m_Device->GetUploader().Upload(m_VertexBuffer->GetVkBuffer(), 0, vertices, bufferSize);
 	}
 
-	void GModel::CreateIndexBuffers(const std::vector<uint32_t>& indices) {
+	void GModel::CreateIndexBuffers(const void* indices) {
 		if (!m_HasIndexBuffer)
 			return;
 
-		VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
-
-		VkBuffer stagingBuffer;
-		VkDeviceMemory stagingBufferMem;
-
-		GBuffer::CreateBuffer(
-			  m_Device
-			, bufferSize
-			, VK_BUFFER_USAGE_TRANSFER_SRC_BIT
-			, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-			, stagingBuffer
-			, stagingBufferMem
-		);
-
-		void* data;
-		vkMapMemory(m_Device->GetDevice(), stagingBufferMem, 0, bufferSize, 0, &data);
-		memcpy(data, m_Indices.data(), (size_t)bufferSize);
-		vkUnmapMemory(m_Device->GetDevice(), stagingBufferMem);
+		VkDeviceSize bufferSize = static_cast<VkDeviceSize>(GetIndexStride()) * m_IndexCount;
 
 		GBuffer::CreateBuffer(
 			  m_Device
@@ -165,10 +208,7 @@ namespace Render {
 			, m_IndexBufferMem
 		);
 
-		GBuffer::CopyBuffer(m_Device, stagingBuffer, m_IndexBuffer->GetVkBuffer(), bufferSize);
-
-		vkDestroyBuffer(m_Device->GetDevice(), stagingBuffer, nullptr);
-		vkFreeMemory(m_Device->GetDevice(), stagingBufferMem, nullptr);
+		m_Device->GetUploader().Upload(m_IndexBuffer->GetVkBuffer(), 0, indices, bufferSize);
 	}
 
 	/// <summary>
@@ -180,19 +220,20 @@ namespace Render {
 		vkCmdBindVertexBuffers(commBuffer, 0, 1, buffers, offsets);
 
 		if (m_HasIndexBuffer)
-			vkCmdBindIndexBuffer(commBuffer, m_IndexBuffer->GetVkBuffer(), 0, VK_INDEX_TYPE_UINT32);
+			vkCmdBindIndexBuffer(commBuffer, m_IndexBuffer->GetVkBuffer(), 0, m_IndexType);
 	}
 
 	/// <summary>
-	/// Draws model
+	/// Draws instanceCount copies of the model, the instances are read from
+	/// the instance buffer bound at binding 1 starting at firstInstance
 	/// </summary>
-	void GModel::Draw(VkCommandBuffer& commBuffer) {
+	void GModel::Draw(VkCommandBuffer& commBuffer, uint32_t instanceCount, uint32_t firstInstance) {
 		if (!m_HasIndexBuffer) {
-			vkCmdDraw(commBuffer, static_cast<uint32_t>(m_Vertices.size()), 1, 0, 0);
+			vkCmdDraw(commBuffer, m_VertexCount, instanceCount, 0, firstInstance);
 			return;
 		}
 
-		vkCmdDrawIndexed(commBuffer, static_cast<uint32_t>(m_Indices.size()), 1, 0, 0, 0);
+		vkCmdDrawIndexed(commBuffer, m_IndexCount, instanceCount, 0, 0, firstInstance);
 	}
 
 }
@@ -3,6 +3,8 @@
 // Core
 #include <Defs.h>
 #include <Core/Graphics/Vertex.h>
+#include "GAllocator.h"
+#include "GMeshOptimizer.h"
 //
 
 // Vulkan
@@ -26,28 +28,38 @@ namespace Render {
 		GModel(GDevice& device, const std::string& modelPath);
 		~GModel();
 
+		// Loads the mesh from its .mesh cache, the OBJ is only parsed when the cache is missing or stale
 		void LoadModel(const std::string& path);
 	
 		void Bind(VkCommandBuffer& commBuffer);
-		void Draw(VkCommandBuffer& commBuffer);
+		void Draw(VkCommandBuffer& commBuffer, uint32_t instanceCount = 1, uint32_t firstInstance = 0);
+
+		// Simulated vertex shader invocations of one instance, before and after the mesh optimization
+		inline const GMeshStats& GetStats() const { return m_Stats; }
+		inline VkIndexType GetIndexType() const { return m_IndexType; }
 	private:
 
-		void CreateVertexBuffers(const std::vector<Vertex>& vertices);
-		void CreateIndexBuffers(const std::vector<uint32_t>& indices);
+		void ParseObj(const std::string& path, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+		inline uint32_t GetIndexStride() const { return m_IndexType == VK_INDEX_TYPE_UINT16 ? 2 : 4; }
+
+		// Upload m_VertexCount vertices / m_IndexCount indices of m_IndexType
+		void CreateVertexBuffers(const void* vertices);
+		void CreateIndexBuffers(const void* indices);
 
 		GDevice* m_Device;
 		
 		std::unique_ptr<GBuffer> m_VertexBuffer;
 		std::unique_ptr<GBuffer> m_IndexBuffer;
 		
-		VkDeviceMemory m_VertexBufferMem;
-		VkDeviceMemory m_IndexBufferMem;
+		GAllocation m_VertexBufferMem{};
+		GAllocation m_IndexBufferMem{};
 	
-		uint32_t m_IndexCount;
-		uint32_t m_VertexCount;
+		uint32_t m_IndexCount = 0;
+		uint32_t m_VertexCount = 0;
 
-		std::vector<Vertex> m_Vertices;
-		std::vector<uint32_t> m_Indices;
+		VkIndexType m_IndexType = VK_INDEX_TYPE_UINT32;
+		GMeshStats m_Stats{};
 
 		bool m_HasIndexBuffer = true;
 	};
@@ -18,20 +18,28 @@ namespace Render {
 	public:
 		GObject(GDevice& device, const std::string& modelPath, glm::vec4 color) {
 			this->color = color;
+			m_Model = GetModel(device, modelPath);
+		}
+
+		~GObject() {}
+
+		std::shared_ptr<GModel> GetModelPtr() { return m_Model; }
 
+		// Loads the model on first use, later calls with the same path share it
+		static std::shared_ptr<GModel> GetModel(GDevice& device, const std::string& modelPath) {
 			if (m_ModelBuffer.find(modelPath) == m_ModelBuffer.end()) {
-				m_Model = std::make_shared<GModel>(device, modelPath);
- 				m_ModelBuffer[modelPath] = m_Model;
+				std::shared_ptr<GModel> model = std::make_shared<GModel>(device, modelPath);
+				m_ModelBuffer[modelPath] = model;
 
-				return;
+				return model;
 			}
-			
-			m_Model = m_ModelBuffer[modelPath];
-		}
 
-		~GObject() {}
+			return m_ModelBuffer[modelPath];
+		}
 
-		std::shared_ptr<GModel> GetModelPtr() { return m_Model; }
+		// Drops the shared models, their buffers are released once no object holds them.
+		// Has to run before the device's allocator is destroyed, the map itself outlives it.
+		static void ReleaseModels() { m_ModelBuffer.clear(); }
 	public_var:
 		Trf transform{};
 		glm::vec4 color{1.0f};
@@ -0,0 +1,116 @@
+#include "pch.h"
+#include "GPipelineCache.h"
+#include "GDevice.h"
+
+// Vulkan
+#include <vulkan/vulkan.h>
+//
+
+// STL
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+//
+
+namespace Render {
+
+	GPipelineCache::GPipelineCache(GDevice& device, const std::string& path) {
+		m_Device = &device;
+		m_Path = path;
+
+		vkGetPhysicalDeviceProperties(m_Device->GetPhysicalDevice(), &m_Props);
+
+		std::vector<char> data;
+		std::ifstream file(m_Path, std::ios::binary | std::ios::ate);
+
+		if (file.is_open()) {
+			const std::streamsize fileSize = file.tellg();
+			file.seekg(0);
+
+			FileHeader header{};
+			const FileHeader expected = MakeHeader();
+
+			if (fileSize >= static_cast<std::streamsize>(sizeof(header)) && file.read(reinterpret_cast<char*>(&header), sizeof(header))
+				&& header.magic == expected.magic
+				&& header.version == expected.version
+				&& header.vendorID == expected.vendorID
+				&& header.deviceID == expected.deviceID
+				&& header.driverVersion == expected.driverVersion
+				&& memcmp(header.pipelineCacheUUID, expected.pipelineCacheUUID, VK_UUID_SIZE) == 0
+				&& header.dataSize == static_cast<uint64_t>(fileSize) - sizeof(header)) {
+
+				data.resize(static_cast<size_t>(header.dataSize));
+
+				if (!file.read(data.data(), data.size()))
+					data.clear();
+			}
+		}
+
+		// The driver checks its own header again, a rejected blob only costs the warm start
+		VkPipelineCacheCreateInfo cacheInfo{};
+		cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		cacheInfo.initialDataSize = data.size();
+		cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+		if (vkCreatePipelineCache(m_Device->GetDevice(), &cacheInfo, nullptr, &m_Cache) != VK_SUCCESS) {
+			cacheInfo.initialDataSize = 0;
+			cacheInfo.pInitialData = nullptr;
+			data.clear();
+
+			if (vkCreatePipelineCache(m_Device->GetDevice(), &cacheInfo, nullptr, &m_Cache) != VK_SUCCESS)
+				throw std::runtime_error("Failed to create pipeline cache!");
+		}
+
+		m_Warm = !data.empty();
+	}
+
+	GPipelineCache::~GPipelineCache() {
+		vkDestroyPipelineCache(m_Device->GetDevice(), m_Cache, nullptr);
+	}
+
+	void GPipelineCache::Save() {
+		size_t dataSize = 0;
+		if (vkGetPipelineCacheData(m_Device->GetDevice(), m_Cache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0)
+			return;
+
+		std::vector<char> data(dataSize);
+		if (vkGetPipelineCacheData(m_Device->GetDevice(), m_Cache, &dataSize, data.data()) != VK_SUCCESS)
+			return;
+
+		FileHeader header = MakeHeader();
+		header.dataSize = dataSize;
+
+		// Written next to the old file first, a crash mid-write never leaves a torn cache behind
+		const std::string tempPath = m_Path + ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+
+			if (!file.is_open())
+				return;
+
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(data.data(), dataSize);
+
+			if (!file)
+				return;
+		}
+
+		std::remove(m_Path.c_str());
+		std::rename(tempPath.c_str(), m_Path.c_str());
+	}
+
+	GPipelineCache::FileHeader GPipelineCache::MakeHeader() const {
+		FileHeader header{};
+		header.magic = s_Magic;
+		header.version = s_Version;
+		header.vendorID = m_Props.vendorID;
+		header.deviceID = m_Props.deviceID;
+		header.driverVersion = m_Props.driverVersion;
+		memcpy(header.pipelineCacheUUID, m_Props.pipelineCacheUUID, VK_UUID_SIZE);
+		header.dataSize = 0;
+
+		return header;
+	}
+
+}
\ No newline at end of file
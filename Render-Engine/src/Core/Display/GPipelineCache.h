@@ -0,0 +1,69 @@
+#pragma once
+
+// Vulkan
+#include <vulkan/vulkan_core.h>
+//
+
+// Core
+#include <Defs.h>
+//
+
+// STL
+#include <string>
+//
+
+namespace Render {
+
+	// Forward declare
+	class GDevice;
+
+	/// <summary>
+	/// VkPipelineCache kept on disk between runs.
+	///
+	/// The file starts with a header holding the vendor, device, driver version and
+	/// pipeline cache UUID of the device that wrote it. A file from another device or driver,
+	/// or one that does not pass the checks, is ignored and the cache starts empty (cold).
+	/// </summary>
+	class GPipelineCache {
+	public:
+		NO_COPY(GPipelineCache);
+
+		GPipelineCache(GDevice& device, const std::string& path);
+		~GPipelineCache();
+
+		/// <summary>
+		/// Writes the current cache content to the file
+		/// </summary>
+		void Save();
+
+		inline VkPipelineCache&	GetVkPipelineCache() { return m_Cache; }
+
+		// True when the cache was filled from the file
+		inline bool				IsWarm() const { return m_Warm; }
+
+	private:
+		struct FileHeader {
+			uint32_t magic;
+			uint32_t version;
+			uint32_t vendorID;
+			uint32_t deviceID;
+			uint32_t driverVersion;
+			uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+			uint64_t dataSize;
+		};
+
+		FileHeader MakeHeader() const;
+
+		GDevice* m_Device;
+		std::string m_Path;
+
+		VkPipelineCache m_Cache = VK_NULL_HANDLE;
+		VkPhysicalDeviceProperties m_Props{};
+
+		bool m_Warm = false;
+
+		static constexpr uint32_t s_Magic = 0x43505346; // "FSPC"
+		static constexpr uint32_t s_Version = 1;
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include "pch.h"
+#include "GUniformRing.h"
+#include "GBuffer.h"
+#include "GDevice.h"
+
+// Vulkan
+#include <vulkan/vulkan.h>
+//
+
+// STL
+#include <cstring>
+//
+
+namespace Render {
+
+	GUniformRing::GUniformRing(GDevice& device, VkDeviceSize frameSize, uint32_t frameCount) {
+		m_Device = &device;
+		m_FrameCount = frameCount;
+
+		VkPhysicalDeviceProperties props{};
+		vkGetPhysicalDeviceProperties(m_Device->GetPhysicalDevice(), &props);
+
+		// Dynamic offsets have to be multiples of this, it is a power of two
+		m_Alignment = props.limits.minUniformBufferOffsetAlignment;
+		m_FrameSize = (frameSize + m_Alignment - 1) & ~(m_Alignment - 1);
+
+		GBuffer::CreateBuffer(
+			  m_Device
+			, m_FrameSize * m_FrameCount
+			, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
+			, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+			, m_Buffer
+			, m_Memory
+			, true
+		);
+	}
+
+	GUniformRing::~GUniformRing() {
+		GBuffer::DestroyBuffer(m_Device, m_Buffer, m_Memory);
+	}
+
+	void GUniformRing::BeginFrame(uint32_t frame) {
+		m_FrameStart = m_FrameSize * (frame % m_FrameCount);
+		m_Cursor = m_FrameStart;
+	}
+
+	uint32_t GUniformRing::Push(const void* data, VkDeviceSize size) {
+		const VkDeviceSize offset = (m_Cursor + m_Alignment - 1) & ~(m_Alignment - 1);
+
+		if (offset + size > m_FrameStart + m_FrameSize)
+			throw std::runtime_error("Failed to push uniform data, the frame region is full!");
+
+		memcpy(static_cast<char*>(m_Memory.mapped) + offset, data, static_cast<size_t>(size));
+		m_Cursor = offset + size;
+
+		return static_cast<uint32_t>(offset);
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+// Vulkan
+#include <vulkan/vulkan_core.h>
+//
+
+// Core
+#include <Defs.h>
+#include "GAllocator.h"
+//
+
+namespace Render {
+
+	// Forward declare
+	class GDevice;
+
+	/// <summary>
+	/// One persistently mapped uniform buffer split into a region per frame in flight.
+	///
+	/// Every Push copies into the region of the current frame and returns the offset to
+	/// bind as dynamic offset of a VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC binding,
+	/// so any number of per-view or per-pass uniforms share one buffer and one descriptor.
+	/// A region must not be rewritten before the frame that last used it has finished.
+	/// </summary>
+	class GUniformRing {
+	public:
+		NO_COPY(GUniformRing);
+
+		GUniformRing(GDevice& device, VkDeviceSize frameSize, uint32_t frameCount);
+		~GUniformRing();
+
+		/// <summary>
+		/// Rewinds to the start of the region of frame
+		/// </summary>
+		/// <param name="frame">uint32_t</param>
+		void BeginFrame(uint32_t frame);
+
+		/// <summary>
+		/// Copies size bytes into the current frame region
+		/// </summary>
+		/// <param name="data">const void*</param>
+		/// <param name="size">VkDeviceSize</param>
+		/// <returns>Dynamic offset of the data</returns>
+		uint32_t Push(const void* data, VkDeviceSize size);
+
+		template<typename T>
+		inline uint32_t Push(const T& data) { return Push(&data, sizeof(T)); }
+
+		inline VkBuffer&		GetVkBuffer() { return m_Buffer; }
+		inline VkDeviceSize		GetFrameSize() const { return m_FrameSize; }
+		inline VkDeviceSize		GetAlignment() const { return m_Alignment; }
+
+		// Bytes pushed in the current frame, alignment padding included
+		inline VkDeviceSize		GetUsedBytes() const { return m_Cursor - m_FrameStart; }
+
+	private:
+		GDevice* m_Device;
+
+		VkBuffer m_Buffer = VK_NULL_HANDLE;
+		GAllocation m_Memory{};
+
+		VkDeviceSize m_Alignment = 0;
+		VkDeviceSize m_FrameSize = 0;
+		uint32_t m_FrameCount = 0;
+
+		VkDeviceSize m_FrameStart = 0;
+		VkDeviceSize m_Cursor = 0;
+	};
+
+}
\ No newline at end of file
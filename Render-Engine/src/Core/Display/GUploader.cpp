@@ -0,0 +1,243 @@
+#include "pch.h"
+#include "GUploader.h"
+#include "GBuffer.h"
+#include "GDevice.h"
+
+// Vulkan
+#include <vulkan/vulkan.h>
+//
+
+// STL
+#include <algorithm>
+#include <cstring>
+//
+
+namespace Render {
+
+	GUploader::GUploader(GDevice& device) {
+		m_Device = &device;
+		m_Capacity = s_RingSize;
+
+		GBuffer::CreateBuffer(
+			  m_Device
+			, m_Capacity
+			, VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+			, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+			, m_Ring
+			, m_RingMem
+		);
+
+		// Own pool, the device pool is destroyed before the device on cleanup
+		VkCommandPoolCreateInfo commandPoolInfo{};
+		commandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		commandPoolInfo.queueFamilyIndex = m_Device->GetQFamilies(m_Device->GetPhysicalDevice()).graphicsFamily.value();
+
+		if (vkCreateCommandPool(m_Device->GetDevice(), &commandPoolInfo, nullptr, &m_CommandPool) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create upload command pool!");
+
+		std::array<VkCommandBuffer, s_BatchCount> cmdBuffers{};
+
+		VkCommandBufferAllocateInfo mallocInfo{};
+		mallocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		mallocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		mallocInfo.commandPool = m_CommandPool;
+		mallocInfo.commandBufferCount = s_BatchCount;
+
+		if (vkAllocateCommandBuffers(m_Device->GetDevice(), &mallocInfo, cmdBuffers.data()) != VK_SUCCESS)
+			throw std::runtime_error("Failed to allocate upload command buffers!");
+
+		VkFenceCreateInfo fenceInfo{};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+		for (uint32_t i = 0; i < s_BatchCount; i++) {
+			m_Batches[i].cmdBuffer = cmdBuffers[i];
+
+			if (vkCreateFence(m_Device->GetDevice(), &fenceInfo, nullptr, &m_Batches[i].fence) != VK_SUCCESS)
+				throw std::runtime_error("Failed to create upload fence!");
+		}
+	}
+
+	GUploader::~GUploader() {
+		WaitIdle();
+
+		for (auto& batch : m_Batches)
+			vkDestroyFence(m_Device->GetDevice(), batch.fence, nullptr);
+
+		vkDestroyCommandPool(m_Device->GetDevice(), m_CommandPool, nullptr);
+
+		GBuffer::DestroyBuffer(m_Device, m_Ring, m_RingMem);
+	}
+
+	void GUploader::Upload(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size) {
+		const char* src = static_cast<const char*>(data);
+
+		// Anything larger than half the ring goes in pieces so it never waits on itself
+		const VkDeviceSize maxChunk = m_Capacity / 2;
+
+		while (size > 0) {
+			const VkDeviceSize chunk = std::min(size, maxChunk);
+			const VkDeviceSize ringOffset = Reserve(chunk);
+
+			memcpy(static_cast<char*>(m_RingMem.mapped) + ringOffset, src, static_cast<size_t>(chunk));
+
+			VkBufferCopy bufferCopy{};
+			bufferCopy.srcOffset = ringOffset;
+			bufferCopy.dstOffset = dstOffset;
+			bufferCopy.size = chunk;
+
+			m_PendingCopies.push_back(bufferCopy);
+			m_PendingDst.push_back(dstBuffer);
+
+			m_UploadedBytes += chunk;
+
+			src += chunk;
+			dstOffset += chunk;
+			size -= chunk;
+		}
+	}
+
+	void GUploader::Flush() {
+		Retire();
+
+		if (m_PendingCopies.empty())
+			return;
+
+		// Batches are reused in submission order, the next one is the oldest in flight
+		if (m_InFlight.size() == s_BatchCount)
+			WaitOldest();
+
+		Batch& batch = m_Batches[m_NextBatch];
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		if (vkBeginCommandBuffer(batch.cmdBuffer, &beginInfo) != VK_SUCCESS)
+			throw std::runtime_error("Failed to begin recording upload command buffer!");
+
+		// Consecutive copies to the same buffer go in one call
+		size_t first = 0;
+		for (size_t i = 1; i <= m_PendingCopies.size(); i++) {
+			if (i < m_PendingCopies.size() && m_PendingDst[i] == m_PendingDst[first])
+				continue;
+
+			vkCmdCopyBuffer(batch.cmdBuffer, m_Ring, m_PendingDst[first], static_cast<uint32_t>(i - first), &m_PendingCopies[first]);
+			first = i;
+		}
+
+		// Covers every command submitted after this one on the queue
+		VkMemoryBarrier memBarrier{};
+		memBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		memBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		memBarrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT;
+
+		vkCmdPipelineBarrier(
+			  batch.cmdBuffer
+			, VK_PIPELINE_STAGE_TRANSFER_BIT
+			, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+			, 0, 1
+			, &memBarrier, 0
+			, nullptr, 0
+			, nullptr
+		);
+
+		if (vkEndCommandBuffer(batch.cmdBuffer) != VK_SUCCESS)
+			throw std::runtime_error("Failed to record upload command buffer!");
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &batch.cmdBuffer;
+
+		if (vkQueueSubmit(m_Device->GetGraphicsQueue(), 1, &submitInfo, batch.fence) != VK_SUCCESS)
+			throw std::runtime_error("Failed to submit upload command buffer!");
+
+		batch.bytes = m_PendingBytes;
+		m_InFlight.push_back(m_NextBatch);
+		m_NextBatch = (m_NextBatch + 1) % s_BatchCount;
+
+		m_PendingCopies.clear();
+		m_PendingDst.clear();
+		m_PendingBytes = 0;
+	}
+
+	void GUploader::WaitIdle() {
+		Flush();
+
+		while (!m_InFlight.empty())
+			WaitOldest();
+	}
+
+	VkDeviceSize GUploader::Reserve(VkDeviceSize size) {
+		// Keeps every range, and so the head, aligned
+		size = (size + s_Alignment - 1) & ~(s_Alignment - 1);
+
+		while (true) {
+			Retire();
+
+			if (m_Used == 0)
+				m_Head = 0;
+
+			const VkDeviceSize tail = (m_Head + m_Capacity - m_Used) % m_Capacity;
+			VkDeviceSize offset = UINT64_MAX;
+
+			if (m_Used < m_Capacity) {
+				// Free space is [head, capacity) plus [0, tail)
+				if (tail <= m_Head) {
+					if (m_Capacity - m_Head >= size) {
+						offset = m_Head;
+					}
+					else if (tail >= size) {
+						// The end of the ring is skipped, it is reclaimed with the batch
+						m_Used += m_Capacity - m_Head;
+						m_PendingBytes += m_Capacity - m_Head;
+						offset = 0;
+					}
+				}
+				// Free space is [head, tail)
+				else if (tail - m_Head >= size) {
+					offset = m_Head;
+				}
+			}
+
+			if (offset != UINT64_MAX) {
+				m_Head = (offset + size) % m_Capacity;
+				m_Used += size;
+				m_PendingBytes += size;
+
+				return offset;
+			}
+
+			// Ring is full, the queued copies have to go out before their space can come back
+			Flush();
+			WaitOldest();
+		}
+	}
+
+	void GUploader::Retire() {
+		while (!m_InFlight.empty()) {
+			Batch& batch = m_Batches[m_InFlight.front()];
+
+			if (vkGetFenceStatus(m_Device->GetDevice(), batch.fence) != VK_SUCCESS)
+				break;
+
+			vkResetFences(m_Device->GetDevice(), 1, &batch.fence);
+			m_Used -= batch.bytes;
+			batch.bytes = 0;
+
+			m_InFlight.pop_front();
+		}
+	}
+
+	void GUploader::WaitOldest() {
+		if (m_InFlight.empty())
+			return;
+
+		Batch& batch = m_Batches[m_InFlight.front()];
+		vkWaitForFences(m_Device->GetDevice(), 1, &batch.fence, VK_TRUE, UINT64_MAX);
+
+		Retire();
+	}
+
+}
\ No newline at end of file
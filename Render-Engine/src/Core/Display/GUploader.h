@@ -0,0 +1,110 @@
+#pragma once
+
+// Vulkan
+#include <vulkan/vulkan_core.h>
+//
+
+// Core
+#include <Defs.h>
+#include "GAllocator.h"
+//
+
+// STL
+#include <array>
+#include <deque>
+#include <vector>
+//
+
+namespace Render {
+
+	// Forward declare
+	class GDevice;
+
+	/// <summary>
+	/// Asynchronous buffer uploads through a persistent staging ring.
+	///
+	/// Upload copies the data into the ring right away and queues the buffer copy.
+	/// Flush records every queued copy into one command buffer and submits it on the graphics
+	/// queue with a fence, the ring space is reclaimed once that fence signals. Draws submitted
+	/// after the Flush see the data, nothing waits for the queue to go idle. Only a full ring
+	/// makes Upload wait for the oldest batch in flight.
+	/// </summary>
+	class GUploader {
+	public:
+		NO_COPY(GUploader);
+
+		GUploader(GDevice& device);
+		~GUploader();
+
+		/// <summary>
+		/// Queues a copy of size bytes from data to dstBuffer at dstOffset.
+		/// data can be released as soon as this returns.
+		/// </summary>
+		/// <param name="dstBuffer">VkBuffer, needs VK_BUFFER_USAGE_TRANSFER_DST_BIT</param>
+		/// <param name="dstOffset">VkDeviceSize</param>
+		/// <param name="data">const void*</param>
+		/// <param name="size">VkDeviceSize</param>
+		void Upload(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size);
+
+		/// <summary>
+		/// Submits the queued copies as one batch, does nothing when none are queued
+		/// </summary>
+		void Flush();
+
+		/// <summary>
+		/// Flushes and waits for every batch in flight
+		/// </summary>
+		void WaitIdle();
+
+		inline VkDeviceSize GetCapacity() const { return m_Capacity; }
+		inline VkDeviceSize GetUsedBytes() const { return m_Used; }
+		inline VkDeviceSize GetUploadedBytes() const { return m_UploadedBytes; }
+		inline size_t GetBatchesInFlight() const { return m_InFlight.size(); }
+
+	private:
+		struct Batch {
+			VkCommandBuffer cmdBuffer = VK_NULL_HANDLE;
+			VkFence fence = VK_NULL_HANDLE;
+
+			// Ring bytes taken by the batch, padding included
+			VkDeviceSize bytes = 0;
+		};
+
+		// Returns the ring offset of size free bytes, waits for batches in flight when needed
+		VkDeviceSize Reserve(VkDeviceSize size);
+
+		// Reclaims the ring space of every finished batch
+		void Retire();
+		void WaitOldest();
+
+		GDevice* m_Device;
+
+		VkBuffer m_Ring = VK_NULL_HANDLE;
+		GAllocation m_RingMem{};
+		VkDeviceSize m_Capacity = 0;
+
+		// Next free byte and bytes not yet reclaimed, the oldest live byte is m_Head - m_Used
+		VkDeviceSize m_Head = 0;
+		VkDeviceSize m_Used = 0;
+
+		// Copies and ring bytes of the batch being gathered
+		std::vector<VkBufferCopy> m_PendingCopies;
+		std::vector<VkBuffer> m_PendingDst;
+		VkDeviceSize m_PendingBytes = 0;
+
+		VkCommandPool m_CommandPool = VK_NULL_HANDLE;
+
+		static const uint32_t s_BatchCount = 4;
+		std::array<Batch, s_BatchCount> m_Batches{};
+		uint32_t m_NextBatch = 0;
+
+		// Submitted batches, oldest first
+		std::deque<uint32_t> m_InFlight;
+
+		VkDeviceSize m_UploadedBytes = 0;
+
+		static constexpr VkDeviceSize s_RingSize = 32ull * 1024 * 1024;
+		static constexpr VkDeviceSize s_Alignment = 16;
+	};
+
+}
\ No newline at end of file
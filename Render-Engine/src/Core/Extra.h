@@ -38,6 +38,9 @@ namespace Render {
 		std::optional<uint32_t> graphicsFamily;
 		std::optional<uint32_t> presentFamily;
 
+		// A family without graphics when the device has one, the graphics family otherwise
+		std::optional<uint32_t> computeFamily;
+
 		inline bool IsComplete() { return graphicsFamily.has_value() && presentFamily.has_value(); }
 	};
 
@@ -56,10 +59,4 @@ namespace Render {
 		glm::mat3 Normal();
 	};
 
-	struct PushConstantData {
-		glm::mat4 modelMatrix{ 1.0f };
-		glm::mat4 normalMatrix{ 1.0f };
-		glm::vec4 color;
-	};
-
 }
@@ -0,0 +1,19 @@
+#include "pch.h"
+#include "GpuSimulationState.h"
+
+namespace Render {
+
+	bool GpuSimulationState::bActive = false;
+	bool GpuSimulationState::bSeedPending = false;
+	std::vector<glm::vec3> GpuSimulationState::seedPositions;
+	std::vector<glm::vec3> GpuSimulationState::seedVelocities;
+	GpuSimulationParams GpuSimulationState::params{};
+	uint32_t GpuSimulationState::pendingSteps = 0;
+	float GpuSimulationState::stepSize = 1.0f / 60.0f;
+	uint64_t GpuSimulationState::stepsSubmitted = 0;
+	bool GpuSimulationState::bReadback = false;
+	bool GpuSimulationState::bReadbackReady = false;
+	uint64_t GpuSimulationState::readbackStep = 0;
+	std::vector<Particle> GpuSimulationState::readback;
+
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+// Core
+#include "Particle.h"
+//
+
+// GLM
+#include <glm/vec3.hpp>
+//
+
+// STL
+#include <cstdint>
+#include <vector>
+//
+
+namespace Render {
+
+	/// <summary>
+	/// Parameters of the GPU step, the particle radius and the default box are fixed by App.
+	/// Stiffness and viscosity are in the units of the kernels, the mass makes a particle at rest spacing reach the rest density.
+	/// </summary>
+	struct GpuSimulationParams {
+		float restDensity = 5.0f;
+		float viscosity = 0.5f;
+		float stiffness = 6000.0f;
+		float damping = 0.98f;
+		float gravity = 9.8f;
+		float mass = 4.95f;
+		bool collisions = true;
+
+		// Scales the default box, clamped to [1, GpuSimulationState::s_MaxBoxScale]
+		float boxScale = 1.0f;
+	};
+
+	/// <summary>
+	/// Hand-off between rnd::GpuSimulation, called by the scripts, and the compute passes of App.
+	/// Scripts write it during their update, App::UpdateGpuSimulation consumes it in the same frame.
+	/// </summary>
+	class GpuSimulationState {
+	public:
+		static constexpr uint32_t s_MaxParticles = 65536;
+
+		// Largest box, the grid is allocated for it. Holds s_MaxParticles at the spacing FluidSolver spawns 2500 with in the default box.
+		static constexpr float s_MaxBoxScale = 3.0f;
+
+		static bool bActive;
+
+		// Replaces the particles before the next step
+		static bool bSeedPending;
+		static std::vector<glm::vec3> seedPositions;
+		static std::vector<glm::vec3> seedVelocities;
+
+		static GpuSimulationParams params;
+
+		// Steps asked for since the last frame, all of them stepSize long
+		static uint32_t pendingSteps;
+		static float stepSize;
+
+		// Steps recorded since the last seed
+		static uint64_t stepsSubmitted;
+
+		// While set every frame copies its particles back, bReadbackReady marks a new copy.
+		// readbackStep is the step the copy was taken after, it trails stepsSubmitted by the frames in flight.
+		static bool bReadback;
+		static bool bReadbackReady;
+		static uint64_t readbackStep;
+		static std::vector<Particle> readback;
+	};
+
+}
\ No newline at end of file
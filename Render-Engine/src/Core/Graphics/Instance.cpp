@@ -0,0 +1,34 @@
+#include "pch.h"
+#include "Instance.h"
+
+// Vulkan
+#include <vulkan/vulkan.h>
+//
+
+VkVertexInputBindingDescription Instance::GetBindingDescription() {
+	VkVertexInputBindingDescription bindingDescription{};
+	bindingDescription.binding   = 1;
+	bindingDescription.stride    = sizeof(Instance);
+	bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+	return bindingDescription;
+}
+
+std::array<VkVertexInputAttributeDescription, 5> Instance::GetAttributeDescriptions() {
+	std::array<VkVertexInputAttributeDescription, 5> attrDescriptions{};
+
+	// A mat4 attribute takes one location per column, locations 4 to 7
+	for (uint32_t column = 0; column < 4; column++) {
+		attrDescriptions[column].binding  = 1;
+		attrDescriptions[column].location = 4 + column;
+		attrDescriptions[column].format   = VK_FORMAT_R32G32B32A32_SFLOAT;
+		attrDescriptions[column].offset   = static_cast<uint32_t>(offsetof(Instance, model) + sizeof(glm::vec4) * column);
+	}
+
+	attrDescriptions[4].binding  = 1;
+	attrDescriptions[4].location = 8;
+	attrDescriptions[4].format   = VK_FORMAT_R32G32B32A32_SFLOAT;
+	attrDescriptions[4].offset   = offsetof(Instance, color);
+
+	return attrDescriptions;
+}
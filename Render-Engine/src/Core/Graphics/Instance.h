@@ -0,0 +1,22 @@
+#pragma once
+
+// GLM
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+//
+
+// STL
+#include <array>
+//
+
+struct VkVertexInputBindingDescription;
+struct VkVertexInputAttributeDescription;
+
+// Per-instance data of the instanced draws, read from vertex binding 1
+struct Instance {
+	glm::mat4 model{ 1.0f };
+	glm::vec4 color{ 1.0f };
+
+	static VkVertexInputBindingDescription GetBindingDescription();
+	static std::array<VkVertexInputAttributeDescription, 5> GetAttributeDescriptions();
+};
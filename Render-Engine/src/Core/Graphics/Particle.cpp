@@ -5,9 +5,9 @@
 
 VkVertexInputBindingDescription Particle::GetBindingDescription() {
 	VkVertexInputBindingDescription bindingDesc{};
-	bindingDesc.binding = 0;
+	bindingDesc.binding = 1;
 	bindingDesc.stride = sizeof(Particle);
-	bindingDesc.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+	bindingDesc.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
 
 	return bindingDesc;
 }
@@ -15,13 +15,14 @@ VkVertexInputBindingDescription Particle::GetBindingDescription() {
 std::array<VkVertexInputAttributeDescription, 2> Particle::GetAttributeDescriptions() {
 	std::array<VkVertexInputAttributeDescription, 2> attrDesc{};
 
-	attrDesc[0].binding = 0;
-	attrDesc[0].location = 0;
+	// Locations 0 to 3 are the mesh vertex
+	attrDesc[0].binding = 1;
+	attrDesc[0].location = 4;
 	attrDesc[0].format = VK_FORMAT_R32G32B32_SFLOAT;
 	attrDesc[0].offset = offsetof(Particle, pos);
 
-	attrDesc[1].binding = 0;
-	attrDesc[1].location = 1;
+	attrDesc[1].binding = 1;
+	attrDesc[1].location = 5;
 	attrDesc[1].format = VK_FORMAT_R32G32B32A32_SFLOAT;
 	attrDesc[1].offset = offsetof(Particle, color);
 
@@ -11,13 +11,44 @@
 
 // STL
 #include <array>
+#include <cstddef>
+#include <cstdint>
 //
 
+// Element of the particle SSBOs of shader.comp (std430, 48 bytes), bound as vertex binding 1 when drawn
 struct Particle {
 	glm::vec3 pos;
+	float density;
 	glm::vec3 vel;
+	float pressure;
 	glm::vec4 color;
 
 	static VkVertexInputBindingDescription GetBindingDescription();
 	static std::array<VkVertexInputAttributeDescription, 2> GetAttributeDescriptions();
 };
+
+// Push constants of shader.comp, passIndex picks the pass of the step
+struct SimulationConstants {
+	uint32_t passIndex;
+	uint32_t particleCount;
+	uint32_t cellCount;
+	uint32_t collisions;
+	glm::ivec3 gridDim;
+	float cellSize;
+	glm::vec3 boxSize;
+	float dt;
+	float radius;
+	float restDensity;
+	float viscosity;
+	float stiffness;
+	float damping;
+	float gravity;
+	float mass;
+};
+
+// shader.comp reads both with std430 offsets, the vertex input of particle.vert reads pos and color
+static_assert(sizeof(Particle) == 48 && offsetof(Particle, density) == 12 && offsetof(Particle, vel) == 16
+	&& offsetof(Particle, pressure) == 28 && offsetof(Particle, color) == 32, "Particle has to match the std430 layout of shader.comp!");
+
+static_assert(offsetof(SimulationConstants, gridDim) == 16 && offsetof(SimulationConstants, boxSize) == 32
+	&& offsetof(SimulationConstants, mass) == 72 && sizeof(SimulationConstants) <= 128, "SimulationConstants has to match the push constants of shader.comp and fit the guaranteed 128 bytes!");
\ No newline at end of file
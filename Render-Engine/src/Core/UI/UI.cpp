@@ -3,6 +3,8 @@
 
 // Core
 #include <Core/Display/GDevice.h>
+#include <Core/Display/GAllocator.h>
+#include <Core/Display/GUploader.h>
 //
 
 // ImGUI
@@ -22,6 +24,7 @@
 //
 
 // STL
+#include <algorithm>
 #include <string>
 #include <sstream>
 #include <iomanip>
@@ -35,8 +38,15 @@ namespace Render {
 	float UI::cameraVelocity[3] = { 0.0f, 0.0f, 0.0f };
 	int UI::cursorDelta[2] = { 0, 0 };
 	uint32_t UI::fps = 0;
+	float UI::startupMs = 0.0f;
+	float UI::pipelineMs = 0.0f;
+	bool UI::bPipelineCacheWarm = false;
+	uint64_t UI::vertexInvocationsBefore = 0;
+	uint64_t UI::vertexInvocationsAfter = 0;
 	int UI::canvasWidth = 0;
 	int UI::canvasHeight = 0;
+	GAllocator* UI::allocator = nullptr;
+	GUploader* UI::uploader = nullptr;
 
 	bool UI::bReset = false;
 	bool UI::bCollisions = true;
@@ -45,6 +55,25 @@ namespace Render {
 	float UI::restDesnity = 5.0f;
 	float UI::damping = 0.98f;
 	float UI::stiffness = 3.0f;
+	int UI::pressureModel = 0;
+	float UI::densityTolerance = 0.01f;
+	int UI::maxPressureIterations = 8;
+	int UI::pbfIterations = 4;
+	int UI::pressureIterations = 0;
+	float UI::pressureError = 0.0f;
+	uint32_t UI::supportedPressureModels = 1;
+	int UI::stepRate = 60;
+	int UI::maxSubsteps = 4;
+	int UI::substeps = 0;
+	float UI::droppedTime = 0.0f;
+	std::vector<std::string> UI::solverBackends;
+	std::vector<int> UI::solverMaxParticles;
+	int UI::solverBackend = 0;
+	int UI::crossCheckBackend = -1;
+	bool UI::bCrossCheckValid = false;
+	uint64_t UI::crossCheckStep = 0;
+	float UI::crossCheckMaxError = 0.0f;
+	float UI::crossCheckRmsError = 0.0f;
 	int UI::particleCount = 1000;
 	int UI::xSpeed = 0;
 	int UI::ySpeed = 0;
@@ -81,6 +110,9 @@ namespace Render {
 
 		vkDeviceWaitIdle(device->GetDevice());
 		ImGui_ImplVulkan_DestroyFontUploadObjects();
+
+		allocator = &device->GetAllocator();
+		uploader = &device->GetUploader();
 	}
 
 	void UI::End() {
@@ -98,6 +130,7 @@ namespace Render {
 		FPS();
 
 		Simulation();
+		Memory();
 
 		ImGui::Render();
 		ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), commBuffer);
@@ -115,6 +148,8 @@ namespace Render {
 	void UI::FPS() {
 		ImGui::Begin("FPS");
 		ImGui::Text("%d", fps);
+		ImGui::Text("Startup: %.1f ms, pipelines %.1f ms (%s cache)", startupMs, pipelineMs, bPipelineCacheWarm ? "warm" : "cold");
+		ImGui::Text("VS invocations: %llu (%llu unoptimized)", static_cast<unsigned long long>(vertexInvocationsAfter), static_cast<unsigned long long>(vertexInvocationsBefore));
 		ImGui::End();
 	}
 
@@ -124,17 +159,109 @@ namespace Render {
 		ImGui::SliderFloat("Viscosity", &viscosity, 0.0f, 2.0f);
 		ImGui::SliderFloat("Damping", &damping, 0.0f, 1.0f);
 		ImGui::SliderFloat("Stiffness", &stiffness, 0.1f, 10.0f);
+		static const char* s_PressureModels[] = { "Stiffness", "PCISPH", "PBF" };
+
+		// Models the backend can't run stay listed, but can't be picked
+		if (ImGui::BeginCombo("Pressure", s_PressureModels[pressureModel])) {
+			for (int model = 0; model < IM_ARRAYSIZE(s_PressureModels); model++) {
+				const bool supported = supportedPressureModels & (1u << model);
+
+				if (ImGui::Selectable(s_PressureModels[model], pressureModel == model, supported ? 0 : ImGuiSelectableFlags_Disabled))
+					pressureModel = model;
+			}
+
+			ImGui::EndCombo();
+		}
+
+		// Picked before a Reset switched to a backend without it
+		const bool pressureSupported = supportedPressureModels & (1u << pressureModel);
+
+		if (!pressureSupported)
+			ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.2f, 1.0f), "%s isn't supported by this backend, running Stiffness", s_PressureModels[pressureModel]);
+		else if (pressureModel == 1) {
+			ImGui::SliderFloat("Density tolerance", &densityTolerance, 0.001f, 0.1f, "%.3f");
+			ImGui::SliderInt("Max iterations", &maxPressureIterations, 1, 50);
+		}
+		else if (pressureModel == 2) {
+			ImGui::SliderInt("PBF iterations", &pbfIterations, 1, 20);
+		}
+
+		if (pressureSupported && pressureModel != 0)
+			ImGui::Text("Iterations: %d, density error: %.2f%%", pressureIterations, pressureError * 100.0f);
+
 		ImGui::Checkbox("Gravity", &bGravity);
 		ImGui::Checkbox("Collisions", &bCollisions);
+		// PCISPH stays stable at several times the step size of the stiffness model
+		ImGui::SliderInt("Step rate (Hz)", &stepRate, 5, 480);
+		ImGui::SliderInt("Max substeps", &maxSubsteps, 1, 32);
+		ImGui::Text("Substeps: %d", substeps);
+		ImGui::Text("Dropped time: %.3f s", droppedTime);
 		ImGui::End();
 
 		ImGui::Begin("Initialize");
-		ImGui::SliderInt("Particle Count", &particleCount, 1, 2500);
+		// Backends differ in how many particles they keep interactive
+		const bool hasBackend = solverBackend >= 0 && solverBackend < static_cast<int>(solverMaxParticles.size());
+		const int maxParticles = hasBackend ? solverMaxParticles[solverBackend] : 2500;
+		particleCount = std::min(particleCount, maxParticles);
+
+		ImGui::SliderInt("Particle Count", &particleCount, 1, maxParticles);
 		ImGui::SliderInt("X Velocity", &xSpeed, -15, 15);
 		ImGui::SliderInt("Y Velocity", &ySpeed, -15, 15);
 		ImGui::SliderInt("Z Velocity", &zSpeed, -15, 15);
+		SolverBackends();
 		bReset = ImGui::Button("Reset");
 		ImGui::End();
 	}
 
+	void UI::SolverBackends() {
+		if (solverBackends.empty())
+			return;
+
+		const int backendCount = static_cast<int>(solverBackends.size());
+		ImGui::Combo("Backend", &solverBackend, [](void*, int index, const char** text) {
+			*text = solverBackends[index].c_str();
+			return true;
+		}, nullptr, backendCount);
+
+		// Entry 0 is "Off", the rest are shifted by one
+		int crossCheck = crossCheckBackend + 1;
+		ImGui::Combo("Cross-check", &crossCheck, [](void*, int index, const char** text) {
+			*text = index == 0 ? "Off" : solverBackends[index - 1].c_str();
+			return true;
+		}, nullptr, backendCount + 1);
+		crossCheckBackend = crossCheck - 1;
+
+		if (crossCheckBackend >= 0) {
+			if (bCrossCheckValid)
+				ImGui::Text("Divergence at step %llu: max %.5f, rms %.5f", static_cast<unsigned long long>(crossCheckStep), crossCheckMaxError, crossCheckRmsError);
+			else
+				ImGui::Text("Divergence: waiting for a common step");
+		}
+	}
+
+	void UI::Memory() {
+		if (!allocator)
+			return;
+
+		ImGui::Begin("GPU memory");
+
+		for (const auto& stats : allocator->GetStats()) {
+			const bool deviceLocal = stats.flags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+			const bool hostVisible = stats.flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+
+			ImGui::Text("Type %u%s%s", stats.memType, deviceLocal ? " device local" : "", hostVisible ? " host visible" : "");
+			ImGui::Text("  Live: %.2f MB in %u allocations", stats.liveBytes / (1024.0 * 1024.0), stats.allocationCount);
+			ImGui::Text("  Blocks: %.2f MB in %u blocks", stats.blockBytes / (1024.0 * 1024.0), stats.blockCount);
+		}
+
+		if (uploader) {
+			ImGui::Separator();
+			ImGui::Text("Staging ring: %.2f / %.2f MB", uploader->GetUsedBytes() / (1024.0 * 1024.0), uploader->GetCapacity() / (1024.0 * 1024.0));
+			ImGui::Text("  Batches in flight: %zu", uploader->GetBatchesInFlight());
+			ImGui::Text("  Uploaded: %.2f MB", uploader->GetUploadedBytes() / (1024.0 * 1024.0));
+		}
+
+		ImGui::End();
+	}
+
 }
\ No newline at end of file
@@ -4,9 +4,17 @@
 #include <vulkan/vulkan_core.h>
 //
 
+// STL
+#include <cstdint>
+#include <string>
+#include <vector>
+//
+
 namespace Render {
 
 	class GDevice;
+	class GAllocator;
+	class GUploader;
 
 	/// <summary>
 	/// Static UI Class
@@ -36,7 +44,23 @@ namespace Render {
 		// Simulation
 		static void Simulation();
 
+		// Backend pickers and the cross-check report, drawn inside the Initialize window
+		static void SolverBackends();
+
+		// GPU memory per memory type
+		static void Memory();
+
 		static uint32_t fps;
+
+		// Time spent in App::Init and in building the pipelines, with or without a cache from disk
+		static float startupMs;
+		static float pipelineMs;
+		static bool bPipelineCacheWarm;
+
+		// Simulated vertex shader invocations of the last frame, with the meshes as loaded and as optimized
+		static uint64_t vertexInvocationsBefore;
+		static uint64_t vertexInvocationsAfter;
+
 		static float cameraPosition[3];
 		static float cameraRotation[3];
 		static float cameraVelocity[3];
@@ -45,6 +69,9 @@ namespace Render {
 		static int canvasWidth;
 		static int canvasHeight;
 
+		static GAllocator* allocator;
+		static GUploader* uploader;
+
 		static bool bReset;
 		static bool bGravity;
 		static bool bCollisions;
@@ -53,6 +80,35 @@ namespace Render {
 		static float damping;
 		static float stiffness;
 
+		// 0 stiffness, 1 PCISPH, 2 PBF. The iterations and the mean compression of the compressed particles are of the last step.
+		static int pressureModel;
+		static float densityTolerance;
+		static int maxPressureIterations;
+		static int pbfIterations;
+		static int pressureIterations;
+		static float pressureError;
+
+		// Bit n is set when the running backends support pressureModel n, the others are greyed out
+		static uint32_t supportedPressureModels;
+
+		static int stepRate;
+		static int maxSubsteps;
+		static int substeps;
+		static float droppedTime;
+
+		// Solver backends registered by the Simulation script and their particle count limits.
+		// The picked backend and the cross-checked one (-1 for none) are applied on Reset.
+		static std::vector<std::string> solverBackends;
+		static std::vector<int> solverMaxParticles;
+		static int solverBackend;
+		static int crossCheckBackend;
+
+		// Divergence of the cross-checked backend at crossCheckStep
+		static bool bCrossCheckValid;
+		static uint64_t crossCheckStep;
+		static float crossCheckMaxError;
+		static float crossCheckRmsError;
+
 		static int particleCount;
 		static int xSpeed;
 		static int ySpeed;
@@ -0,0 +1,84 @@
+#include "pch.h"
+#include "DrawList.h"
+
+NAMESPACE_START_SCOPE_RND
+
+void DrawList::Add(ObjectSettings* settings) {
+	// Registering again, e.g. on a model change, is an update
+	if (settings->listed) {
+		MarkDirty(settings);
+		return;
+	}
+
+	settings->listed = true;
+	settings->dirty = true;
+	m_Count++;
+
+	auto pending = m_Pending.find(settings->id);
+
+	// Removed and added back within one frame, the renderer still has it
+	if (pending != m_Pending.end() && pending->second.change == Change::Removed) {
+		pending->second = PendingChange{ Change::Updated, settings };
+		return;
+	}
+
+	m_Pending[settings->id] = PendingChange{ Change::Added, settings };
+}
+
+void DrawList::MarkDirty(ObjectSettings* settings) {
+	// Unlisted objects are not drawn, dirty ones are already pending
+	if (!settings->listed || settings->dirty)
+		return;
+
+	settings->dirty = true;
+	m_Pending[settings->id] = PendingChange{ Change::Updated, settings };
+}
+
+void DrawList::Remove(ObjectSettings* settings) {
+	if (!settings->listed)
+		return;
+
+	settings->listed = false;
+	settings->dirty = false;
+	m_Count--;
+
+	auto pending = m_Pending.find(settings->id);
+
+	// Never reached the renderer, nothing to remove there
+	if (pending != m_Pending.end() && pending->second.change == Change::Added) {
+		m_Pending.erase(pending);
+		return;
+	}
+
+	// Only the id is kept, the settings die with their entity
+	m_Pending[settings->id] = PendingChange{ Change::Removed, nullptr };
+}
+
+const DrawListDelta& DrawList::ConsumeDelta() {
+	m_Delta.added.clear();
+	m_Delta.updated.clear();
+	m_Delta.removed.clear();
+
+	for (const auto& elem : m_Pending) {
+		switch (elem.second.change) {
+		case Change::Added:
+			m_Delta.added.push_back(elem.second.settings);
+			elem.second.settings->dirty = false;
+			break;
+		case Change::Updated:
+			m_Delta.updated.push_back(elem.second.settings);
+			elem.second.settings->dirty = false;
+			break;
+		case Change::Removed:
+			m_Delta.removed.push_back(elem.first);
+			break;
+		}
+	}
+
+	m_Pending.clear();
+	m_Delta.version++;
+
+	return m_Delta;
+}
+
+NAMESPACE_END_SCOPE_RND
@@ -0,0 +1,68 @@
+#pragma once
+
+// STL
+#include <vector>
+#include <unordered_map>
+//
+
+// Core
+#include "ObjectSettings.h"
+#include <Defs.h>
+//
+
+NAMESPACE_START_SCOPE_RND
+
+/// <summary>
+/// Changes of the draw list since the previous frame
+/// </summary>
+struct DrawListDelta {
+	std::vector<ObjectSettings*> added;
+	std::vector<ObjectSettings*> updated;
+	std::vector<uint64_t> removed;
+
+	// Incremented on every consume, tells deltas of different frames apart
+	uint64_t version = 0;
+};
+
+/// <summary>
+/// Change tracked draw list.
+/// 
+/// Entities report when they are added, changed or removed, the renderer consumes
+/// the collected changes once per frame. Only objects that changed are visited,
+/// so the per-frame cost does not grow with the size of the scene.
+/// </summary>
+class DrawList {
+public:
+	void Add(ObjectSettings* settings);
+	void MarkDirty(ObjectSettings* settings);
+	void Remove(ObjectSettings* settings);
+
+	/// <summary>
+	/// Returns the changes since the previous call and starts collecting the next ones.
+	/// The delta stays valid until the next call.
+	/// </summary>
+	const DrawListDelta& ConsumeDelta();
+
+	inline uint64_t GetVersion() const { return m_Delta.version; }
+	inline size_t	Size() const { return m_Count; }
+
+private:
+	enum class Change : uint8_t {
+		  Added
+		, Updated
+		, Removed
+	};
+
+	struct PendingChange {
+		Change change;
+		ObjectSettings* settings;
+	};
+
+	// At most one pending change per id, folded together as more changes come in
+	std::unordered_map<uint64_t, PendingChange> m_Pending;
+
+	DrawListDelta m_Delta;
+	size_t m_Count = 0;
+};
+
+NAMESPACE_END_SCOPE_RND
@@ -17,7 +17,7 @@ RENDER_API Entity::Entity() {
 }
 
 RENDER_API Entity::~Entity() {
-	m_ORenderer->m_DrawListSettings.erase(objSettings.id);
+	m_ORenderer->m_DrawList.Remove(&objSettings);
 }
 
 RENDER_API void Entity::SetModel(std::string path, glm::vec4 color) {
@@ -27,11 +27,12 @@ RENDER_API void Entity::SetModel(std::string path, glm::vec4 color) {
 
 	objSettings.path = path;
 	objSettings.color = color;
-	m_ORenderer->m_DrawListSettings[objSettings.id] = &objSettings;
+	m_ORenderer->m_DrawList.Add(&objSettings);
 }
 
 RENDER_API void Entity::SetColor(glm::vec4 color) {
 	objSettings.color = color;
+	m_ORenderer->m_DrawList.MarkDirty(&objSettings);
 }
 
 RENDER_API rnd::Transform Entity::GetTransfrom() {
@@ -40,18 +41,22 @@ RENDER_API rnd::Transform Entity::GetTransfrom() {
 
 RENDER_API void Entity::SetTransform(const rnd::Transform& transform) {
 	objSettings.transform = transform;
+	m_ORenderer->m_DrawList.MarkDirty(&objSettings);
 }
 
 RENDER_API void Entity::SetRotation(glm::vec3 rotate) {
 	objSettings.transform.rotate = rotate;
+	m_ORenderer->m_DrawList.MarkDirty(&objSettings);
 }
 
 RENDER_API void Entity::SetTranslation(glm::vec3 translate) {
 	objSettings.transform.translate = translate;
+	m_ORenderer->m_DrawList.MarkDirty(&objSettings);
 }
 
 RENDER_API void Entity::SetScale(glm::vec3 scale) {
 	objSettings.transform.scale = scale;
+	m_ORenderer->m_DrawList.MarkDirty(&objSettings);
 }
 
 NAMESPACE_END_SCOPE_RND
\ No newline at end of file
@@ -0,0 +1,74 @@
+#include "pch.h"
+#include "GpuSimulation.h"
+
+// STL
+#include <algorithm>
+#include <stdexcept>
+//
+
+using Render::GpuSimulationState;
+
+NAMESPACE_START_SCOPE_RND
+
+RENDER_API void GpuSimulation::Start(std::span<const glm::vec3> positions, std::span<const glm::vec3> velocities) {
+	if (positions.size() != velocities.size())
+		throw std::runtime_error("Failed to start GPU simulation, position and velocity counts differ!");
+
+	const size_t count = std::min<size_t>(positions.size(), GpuSimulationState::s_MaxParticles);
+
+	GpuSimulationState::seedPositions.assign(positions.begin(), positions.begin() + count);
+	GpuSimulationState::seedVelocities.assign(velocities.begin(), velocities.begin() + count);
+	GpuSimulationState::bSeedPending = true;
+	GpuSimulationState::bActive = true;
+
+	GpuSimulationState::pendingSteps = 0;
+	GpuSimulationState::stepsSubmitted = 0;
+	GpuSimulationState::bReadbackReady = false;
+}
+
+RENDER_API void GpuSimulation::Stop() {
+	GpuSimulationState::bActive = false;
+	GpuSimulationState::bSeedPending = false;
+	GpuSimulationState::pendingSteps = 0;
+}
+
+RENDER_API void GpuSimulation::SetParams(const Render::GpuSimulationParams& params) {
+	GpuSimulationState::params = params;
+}
+
+RENDER_API void GpuSimulation::Step(float dt) {
+	GpuSimulationState::stepSize = dt;
+	GpuSimulationState::pendingSteps++;
+}
+
+RENDER_API void GpuSimulation::SetReadback(bool enabled) {
+	GpuSimulationState::bReadback = enabled;
+}
+
+RENDER_API bool GpuSimulation::ReadParticles(std::vector<glm::vec3>& positions, std::vector<glm::vec3>& velocities, std::vector<float>& densities, uint64_t& step) {
+	if (!GpuSimulationState::bReadbackReady)
+		return false;
+
+	const std::vector<Particle>& particles = GpuSimulationState::readback;
+
+	positions.resize(particles.size());
+	velocities.resize(particles.size());
+	densities.resize(particles.size());
+
+	for (size_t i = 0; i < particles.size(); i++) {
+		positions[i] = particles[i].pos;
+		velocities[i] = particles[i].vel;
+		densities[i] = particles[i].density;
+	}
+
+	step = GpuSimulationState::readbackStep;
+	GpuSimulationState::bReadbackReady = false;
+
+	return true;
+}
+
+RENDER_API uint32_t GpuSimulation::GetMaxParticles() {
+	return GpuSimulationState::s_MaxParticles;
+}
+
+NAMESPACE_END_SCOPE_RND
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+// Core
+#include <Defs.h>
+#include <Core/Graphics/GpuSimulationState.h>
+//
+
+// GLM
+#include <glm/vec3.hpp>
+//
+
+// STL
+#include <cstdint>
+#include <span>
+#include <vector>
+//
+
+NAMESPACE_START_SCOPE_RND
+
+/// <summary>
+/// Fluid steps run by the renderer's compute passes (shader.comp) and drawn straight from the GPU buffers.
+/// The caller owns the timestep: every Step is run in the next frame, at the latest.
+/// </summary>
+class GpuSimulation {
+public:
+	/// <summary>
+	/// Replaces the particles before the next step and starts drawing them, positions[i] and velocities[i] describe particle i
+	/// </summary>
+	RENDER_API static void Start(std::span<const glm::vec3> positions, std::span<const glm::vec3> velocities);
+	RENDER_API static void Stop();
+
+	RENDER_API static void SetParams(const Render::GpuSimulationParams& params);
+
+	/// <summary>
+	/// Queues one step of dt seconds, steps of the same frame should share dt
+	/// </summary>
+	RENDER_API static void Step(float dt);
+
+	/// <summary>
+	/// Copies the particles back after every frame while enabled
+	/// </summary>
+	RENDER_API static void SetReadback(bool enabled);
+
+	/// <summary>
+	/// Latest copy of the particles, in particle order
+	/// </summary>
+	/// <returns>false when nothing new arrived since the last call</returns>
+	RENDER_API static bool ReadParticles(std::vector<glm::vec3>& positions, std::vector<glm::vec3>& velocities, std::vector<float>& densities, uint64_t& step);
+
+	RENDER_API static uint32_t GetMaxParticles();
+};
+
+NAMESPACE_END_SCOPE_RND
\ No newline at end of file
@@ -25,7 +25,12 @@ RENDER_API ORenderer::~ORenderer() {}
 RENDER_API int ORenderer::Execute() {
 	try {
 		Render::App context;
-		context.Run([&]() { return CallStart(); }, [&]() { return CallUpdate(); }, [&]() -> std::unordered_map<uint64_t, ObjectSettings*> { return GetDrawList(); });
+		context.Run(
+			  [&]() { return CallStart(); }
+			, [&]() { return CallUpdate(); }
+			, [&]() -> const DrawListDelta& { return GetDrawList(); }
+			, [&]() -> const std::unordered_map<uint64_t, ParticleBatch*>& { return GetParticleBatches(); }
+		);
 		return EXIT_SUCCESS;
 	}
 	catch (const std::exception& e) {
@@ -54,8 +59,12 @@ void ORenderer::CallUpdate() {
 		func();
 }
 
-std::unordered_map<uint64_t, ObjectSettings*> ORenderer::GetDrawList() {
-	return m_DrawListSettings;
+const DrawListDelta& ORenderer::GetDrawList() {
+	return m_DrawList.ConsumeDelta();
+}
+
+const std::unordered_map<uint64_t, ParticleBatch*>& ORenderer::GetParticleBatches() {
+	return m_ParticleBatches;
 }
 
 NAMESPACE_END_SCOPE_RND
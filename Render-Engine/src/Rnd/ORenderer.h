@@ -12,7 +12,9 @@
 // Core
 #include <Core/Display/GObject.h>
 
+#include "DrawList.h"
 #include "ObjectSettings.h"
+#include "ParticleBatch.h"
 //
 
 namespace Render {
@@ -52,13 +54,17 @@ private:
 	void CallStart();
 	void CallUpdate();
 
-	std::unordered_map<uint64_t, ObjectSettings*> GetDrawList();
+	const DrawListDelta& GetDrawList();
+	const std::unordered_map<uint64_t, ParticleBatch*>& GetParticleBatches();
 
 	std::vector<std::function<void()>> m_StartFuncs;
 	std::vector<std::function<void()>> m_UpdateFuncs;
 
 	// Draw list
-	std::unordered_map<uint64_t, ObjectSettings*> m_DrawListSettings;
+	DrawList m_DrawList;
+
+	// Particle systems, each one is drawn as a single instanced batch
+	std::unordered_map<uint64_t, ParticleBatch*> m_ParticleBatches;
 
 	// Singleton instance
 	static ORenderer* s_Instance;
@@ -69,6 +75,7 @@ private:
 	friend class ORenderable;
 	friend class OScript;
 	friend class Entity;
+	friend class ParticleSystem;
 };
 
 NAMESPACE_END_SCOPE_RND
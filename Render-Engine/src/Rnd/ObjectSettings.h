@@ -29,6 +29,10 @@ struct ObjectSettings {
 	Transform transform;
 	uint64_t id;
 
+	// Draw list bookkeeping, see DrawList
+	bool listed = false;
+	bool dirty = false;
+
 	static uint64_t s_IdCount;
 };
 
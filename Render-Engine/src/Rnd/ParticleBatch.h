@@ -0,0 +1,41 @@
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+//
+
+// GLM
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+//
+
+// Core
+#include "ObjectSettings.h"
+#include <Defs.h>
+//
+
+NAMESPACE_START_SCOPE_RND
+
+/// <summary>
+/// Render data of a ParticleSystem. Every particle is a copy of the same model,
+/// the whole batch is drawn with a single instanced draw.
+/// </summary>
+struct ParticleBatch {
+	ParticleBatch() {
+		// Shares the counter with ObjectSettings, ids are unique across the draw list
+		id = ObjectSettings::s_IdCount;
+		ObjectSettings::s_IdCount++;
+	}
+
+	std::string path;
+	float scale = 1.0f;
+
+	// positions[i] and colors[i] belong to particle i
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec4> colors;
+
+	uint64_t id;
+};
+
+NAMESPACE_END_SCOPE_RND
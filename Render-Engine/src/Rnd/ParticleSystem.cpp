@@ -0,0 +1,41 @@
+#include "pch.h"
+#include "ParticleSystem.h"
+
+// Core
+#include "ORenderer.h"
+//
+
+NAMESPACE_START_SCOPE_RND
+
+RENDER_API ParticleSystem::ParticleSystem() {
+	m_ORenderer = ORenderer::GetInstance();
+}
+
+RENDER_API ParticleSystem::~ParticleSystem() {
+	m_ORenderer->m_ParticleBatches.erase(m_Batch.id);
+}
+
+RENDER_API void ParticleSystem::SetModel(std::string path, float scale) {
+	// '_' is reserved for generated models
+	if (path.length() == 0 || path[0] == '_')
+		return;
+
+	m_Batch.path = path;
+	m_Batch.scale = scale;
+	m_ORenderer->m_ParticleBatches[m_Batch.id] = &m_Batch;
+}
+
+RENDER_API void ParticleSystem::SetParticles(std::span<const glm::vec3> positions, std::span<const glm::vec4> colors) {
+	if (positions.size() != colors.size())
+		throw std::runtime_error("Failed to set particles, position and color counts differ!");
+
+	m_Batch.positions.assign(positions.begin(), positions.end());
+	m_Batch.colors.assign(colors.begin(), colors.end());
+}
+
+RENDER_API void ParticleSystem::Clear() {
+	m_Batch.positions.clear();
+	m_Batch.colors.clear();
+}
+
+NAMESPACE_END_SCOPE_RND
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <Defs.h>
+#include "ParticleBatch.h"
+
+// STL
+#include <span>
+//
+
+NAMESPACE_START_SCOPE_RND
+
+class ORenderer;
+
+/// <summary>
+/// Draws many copies of one model, one per particle, without an Entity for each of them.
+/// All particles are replaced in one call and handed to the renderer as a single instanced batch.
+/// </summary>
+class ParticleSystem {
+public:
+	NO_COPY(ParticleSystem);
+
+	RENDER_API ParticleSystem();
+	RENDER_API ~ParticleSystem();
+
+	/// <summary>
+	/// Model drawn for every particle, scaled uniformly. Registers the system for drawing.
+	/// </summary>
+	RENDER_API void SetModel(std::string path, float scale);
+
+	/// <summary>
+	/// Replaces all particles, positions[i] and colors[i] describe particle i
+	/// </summary>
+	RENDER_API void SetParticles(std::span<const glm::vec3> positions, std::span<const glm::vec4> colors);
+
+	RENDER_API void Clear();
+
+	inline size_t Size() const { return m_Batch.positions.size(); }
+
+private:
+	ParticleBatch m_Batch;
+
+	ORenderer* m_ORenderer;
+};
+
+NAMESPACE_END_SCOPE_RND
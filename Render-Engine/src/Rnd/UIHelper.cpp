@@ -22,4 +22,48 @@ RENDER_API void UIHelper::ReadSimulationData(bool& reset, bool& gravity, bool& c
 	stiffness = static_cast<double>(Render::UI::stiffness);
 }
 
+RENDER_API void UIHelper::ReadPressureSolver(int& model, double& densityTolerance, int& maxIterations, int& pbfIterations) {
+	model = Render::UI::pressureModel;
+	densityTolerance = static_cast<double>(Render::UI::densityTolerance);
+	maxIterations = Render::UI::maxPressureIterations;
+	pbfIterations = Render::UI::pbfIterations;
+}
+
+RENDER_API void UIHelper::WritePressureSolve(uint32_t iterations, double densityError) {
+	Render::UI::pressureIterations = static_cast<int>(iterations);
+	Render::UI::pressureError = static_cast<float>(densityError);
+}
+
+RENDER_API void UIHelper::WritePressureModels(uint32_t supported) {
+	Render::UI::supportedPressureModels = supported;
+}
+
+RENDER_API void UIHelper::ReadSimulationTimestep(int& stepRate, int& maxSubsteps) {
+	stepRate = Render::UI::stepRate;
+	maxSubsteps = Render::UI::maxSubsteps;
+}
+
+RENDER_API void UIHelper::WriteSimulationTimestep(int substeps, float droppedTime) {
+	Render::UI::substeps = substeps;
+	Render::UI::droppedTime = droppedTime;
+}
+
+RENDER_API void UIHelper::WriteSolverBackends(const std::vector<std::string>& names, const std::vector<int>& maxParticles, int backend) {
+	Render::UI::solverBackends = names;
+	Render::UI::solverMaxParticles = maxParticles;
+	Render::UI::solverBackend = backend;
+}
+
+RENDER_API void UIHelper::ReadSolverBackends(int& backend, int& crossCheck) {
+	backend = Render::UI::solverBackend;
+	crossCheck = Render::UI::crossCheckBackend;
+}
+
+RENDER_API void UIHelper::WriteCrossCheck(bool valid, uint64_t step, double maxError, double rmsError) {
+	Render::UI::bCrossCheckValid = valid;
+	Render::UI::crossCheckStep = step;
+	Render::UI::crossCheckMaxError = static_cast<float>(maxError);
+	Render::UI::crossCheckRmsError = static_cast<float>(rmsError);
+}
+
 NAMESPACE_END_SCOPE_RND
\ No newline at end of file
@@ -2,12 +2,28 @@
 
 #include "defs.h"
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 NAMESPACE_START_SCOPE_RND
 
 class UIHelper {
 public:
 	RENDER_API static void ReadSimulationStartParams(int& xSpeed, int& ySpeed, int& zSpeed, int& particleCount);
 	RENDER_API static void ReadSimulationData(bool& reset, bool& gravity, bool& collisions, double& viscosity, double& restDesnity, double& damping, double& stiffness);
+	RENDER_API static void ReadPressureSolver(int& model, double& densityTolerance, int& maxIterations, int& pbfIterations);
+	RENDER_API static void WritePressureSolve(uint32_t iterations, double densityError);
+
+	// Bit n is set when the running backends support pressure model n
+	RENDER_API static void WritePressureModels(uint32_t supported);
+	RENDER_API static void ReadSimulationTimestep(int& stepRate, int& maxSubsteps);
+	RENDER_API static void WriteSimulationTimestep(int substeps, float droppedTime);
+
+	// Backends offered in the Initialize window, maxParticles[i] caps the particle count of backend i
+	RENDER_API static void WriteSolverBackends(const std::vector<std::string>& names, const std::vector<int>& maxParticles, int backend);
+	RENDER_API static void ReadSolverBackends(int& backend, int& crossCheck);
+	RENDER_API static void WriteCrossCheck(bool valid, uint64_t step, double maxError, double rmsError);
 };
 
 NAMESPACE_END_SCOPE_RND
\ No newline at end of file
@@ -0,0 +1,42 @@
+#version 460
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec4 inColor;
+layout(location = 2) in vec2 inUV;
+layout(location = 3) in vec3 inNormal;
+
+// Per instance, binding 1 is the particle SSBO written by shader.comp
+layout(location = 4) in vec3 inParticlePos;
+layout(location = 5) in vec4 inParticleColor;
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec2 fragUV;
+
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+	mat4 model;
+	mat4 view;
+	mat4 proj;
+	vec4 lightDir;
+	vec4 lightColor;
+	vec4 lightAmbient;
+	vec4 lightDiffuse;
+} uniBuff;
+
+layout(push_constant) uniform ParticleConstants {
+	float scale;
+} particle;
+
+void main() {
+	vec4 posWorld = vec4(inPosition * particle.scale + inParticlePos, 1.0);
+	gl_Position = uniBuff.proj * uniBuff.view * posWorld;
+
+	// Particles are only scaled uniformly and translated
+	vec4 normalWS = vec4(normalize(inNormal), 0);
+
+	float lightIntensity = max(dot(normalWS, uniBuff.lightDir), 0);
+
+	vec4 finalIntensity = lightIntensity * uniBuff.lightDiffuse + uniBuff.lightAmbient;
+
+	fragColor = finalIntensity * inParticleColor;
+	fragUV = inUV;
+}
@@ -5,6 +5,10 @@ layout(location = 1) in vec4 inColor;
 layout(location = 2) in vec2 inUV;
 layout(location = 3) in vec3 inNormal;
 
+// Per instance, binding 1
+layout(location = 4) in mat4 inModel;
+layout(location = 8) in vec4 inInstanceColor;
+
 // layout(location = 4) in vec3 inLightDirection;
 // layout(location = 5) in vec3 inAmbient;
 // layout(location = 5) in vec3 inDiffuse;
@@ -22,22 +26,16 @@ layout(set = 0, binding = 0) uniform UniformBufferObject {
 	vec4 lightDiffuse;
 } uniBuff;
 
-layout(push_constant) uniform Push {
-  mat4 modelMat;
-  mat4 normalMat;
-  vec4 color;
-} push;
-
 void main() {
-	vec4 posWorld = push.modelMat * vec4(inPosition, 1.0);
+	vec4 posWorld = inModel * vec4(inPosition, 1.0);
 	gl_Position = uniBuff.proj * uniBuff.view * posWorld;
 	
-	vec4 normalWS = vec4(normalize(mat3(push.modelMat) * inNormal), 0);
+	vec4 normalWS = vec4(normalize(mat3(inModel) * inNormal), 0);
 
 	float lightIntensity = max(dot(normalWS, uniBuff.lightDir), 0);
 	
 	vec4 finalIntensity = lightIntensity * uniBuff.lightDiffuse + uniBuff.lightAmbient;
 
-	fragColor = finalIntensity * push.color;
+	fragColor = finalIntensity * inInstanceColor;
 	fragUV = inUV;
 }
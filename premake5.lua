@@ -29,6 +29,29 @@ LibDir["Vulkan"] = "C:/VulkanSDK/1.3.243.0/Lib"
 LibDir["GLFW"] = "vendor/lib/glfw/bin/Debug-x86_64/GLFW"
 LibDir["ImGUI"] = "vendor/lib/imgui/bin/Debug-x86_64/ImGUI"
 
+-- Render-free solver sources, shared by App, Headless and Bench.
+-- VulkanSolver needs the renderer, only App compiles it.
+SolverFiles = {
+	"App/src/FluidSolver.h",
+	"App/src/FluidSolver.cpp",
+	"App/src/NeighbourList.h",
+	"App/src/NeighbourList.cpp",
+	"App/src/PairKernels.h",
+	"App/src/PairKernels*.cpp",
+	"App/src/ParticleStore.h",
+	"App/src/ParticleStore.cpp",
+	"App/src/SpatialGrid.h",
+	"App/src/SpatialGrid.cpp",
+	"App/src/SphKernels.h",
+	"App/src/Solver.h",
+	"App/src/SolverRegistry.h",
+	"App/src/SolverRegistry.cpp",
+	"App/src/SolverCrossCheck.h",
+	"App/src/SolverCrossCheck.cpp",
+	"App/src/CpuSolver.h",
+	"App/src/CpuSolver.cpp"
+}
+
 include "vendor/lib/glfw"
 include "vendor/lib/imgui"
 
@@ -71,6 +94,7 @@ project "App"
 		"GLFW.lib",
 		"ImGUI.lib",
 		"vulkan-1.lib",
+		"Engine",
 		"Render-Engine"
 	}
 	
@@ -96,6 +120,118 @@ project "App"
 		buildoptions "/MD"
 		optimize "Speed"
 
+--
+-- Headless
+--
+
+project "Headless"
+	location "Headless"
+	kind "ConsoleApp"
+	language "C++"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("obj/" .. outputdir .. "/%{prj.name}")
+	debugdir("bin/" .. outputdir .. "/App")
+
+	-- No Vulkan, GLFW or ImGui, glm is the only header taken from the SDK folder
+	files {
+		"Headless/src/**.h",
+		"Headless/src/**.cpp",
+		SolverFiles
+	}
+
+	includedirs {
+		"%{IncludeDir.Vulkan}",
+		"Engine/src",
+		"App/src"
+	}
+
+	libdirs {
+		"bin/" .. outputdir .. "/Engine"
+	}
+
+	links {
+		"Engine"
+	}
+
+	filter "system:windows"
+	cppdialect "C++20"
+	staticruntime "On"
+	systemversion "latest"
+
+	defines { "FS_HEADLESS" }
+
+	filter "configurations:Debug"
+	defines "FS_DEBUG"
+	buildoptions "/MDd"
+	symbols "On"
+
+	filter "configurations:Release"
+		defines "FS_RELEASE"
+		buildoptions "/MD"
+		optimize "On"
+
+	filter "configurations:Dist"
+		defines "FS_DIST"
+		buildoptions "/MD"
+		optimize "Speed"
+
+--
+-- Bench
+--
+
+project "Bench"
+	location "Bench"
+	kind "ConsoleApp"
+	language "C++"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("obj/" .. outputdir .. "/%{prj.name}")
+	debugdir("bin/" .. outputdir .. "/App")
+
+	-- Solver sources are compiled in, the renderer is never linked
+	files {
+		"Bench/src/**.h",
+		"Bench/src/**.cpp",
+		SolverFiles
+	}
+
+	includedirs {
+		"%{IncludeDir.Vulkan}",
+		"Engine/src",
+		"App/src"
+	}
+
+	libdirs {
+		"bin/" .. outputdir .. "/Engine"
+	}
+
+	links {
+		"Engine"
+	}
+
+	filter "system:windows"
+	cppdialect "C++20"
+	staticruntime "On"
+	systemversion "latest"
+
+	defines { "FS_BENCH" }
+
+	filter "configurations:Debug"
+	defines "FS_DEBUG"
+	buildoptions "/MDd"
+	symbols "On"
+
+	filter "configurations:Release"
+		defines "FS_RELEASE"
+		buildoptions "/MD"
+		optimize "On"
+
+	filter "configurations:Dist"
+		defines "FS_DIST"
+		buildoptions "/MD"
+		optimize "Speed"
+
 --
 -- Engine
 --
@@ -1,3 +1,4 @@
 %VULKAN_SDK%\Bin\glslc.exe ../Render-Engine/src/Shaders/shader.vert -o ../shaders/bin/vert.spv
 %VULKAN_SDK%\Bin\glslc.exe ../Render-Engine/src/Shaders/shader.frag -o ../shaders/bin/frag.spv
-%VULKAN_SDK%\Bin\glslc.exe ../Render-Engine/src/Shaders/shader.comp -o ../shaders/bin/comp.spv
\ No newline at end of file
+%VULKAN_SDK%\Bin\glslc.exe ../Render-Engine/src/Shaders/shader.comp -o ../shaders/bin/comp.spv
+%VULKAN_SDK%\Bin\glslc.exe ../Render-Engine/src/Shaders/particle.vert -o ../shaders/bin/particle.spv
\ No newline at end of file
@@ -0,0 +1,10 @@
+#!/bin/sh
+# Same as shader_compile.bat, takes glslc from the Vulkan SDK or the PATH
+GLSLC="${VULKAN_SDK:+$VULKAN_SDK/bin/}glslc"
+cd "$(dirname "$0")" || exit 1
+mkdir -p ../shaders/bin
+
+"$GLSLC" ../Render-Engine/src/Shaders/shader.vert -o ../shaders/bin/vert.spv || exit 1
+"$GLSLC" ../Render-Engine/src/Shaders/shader.frag -o ../shaders/bin/frag.spv || exit 1
+"$GLSLC" ../Render-Engine/src/Shaders/shader.comp -o ../shaders/bin/comp.spv || exit 1
+"$GLSLC" ../Render-Engine/src/Shaders/particle.vert -o ../shaders/bin/particle.spv || exit 1